@@ -0,0 +1,265 @@
+#ifndef BITSET_KERNEL_H
+#define BITSET_KERNEL_H
+
+#include <vector>
+#include <cstdint>
+
+#include "csr_graph.h"
+#include "kernel_select.h"
+#include "pivot_rule.h"
+#include "profiling.h"
+
+// Bron-Kerbosch with Tomita pivoting over a small subproblem held as a dense
+// bit matrix. build() renumbers the candidates P to local IDs 0..|P|-1 and the
+// excluded vertices X that still touch P to |P|..k-1; P, X and every
+// neighborhood then become k-bit words, so intersections are word-wise ANDs
+// and the pivot score is a popcount. One instance is reused per worker.
+class LocalBitGraph {
+public:
+    // Largest local vertex count the kernel accepts; bigger subproblems are
+    // left to the caller's general search.
+    static const int MAX_LOCAL_VERTICES = 2048;
+
+    LocalBitGraph()
+        : candidateCount(0), localCount(0), wordCount(0), hasStrayExcluded(false), chosenCount(0),
+          pivotRule(PIVOT_TOMITA), nodeCount(0) {}
+
+    int size() const { return localCount; }
+
+    void setPivotRule(PivotRule rule) { pivotRule = rule; }
+
+    // Search-tree nodes expanded so far, over every subproblem.
+    int64_t searchNodes() const { return nodeCount; }
+
+    // Subproblems offered to build() so far, by the engine they went to.
+    const KernelUsage& usage() const { return kernelUsage; }
+
+    // Loads the subproblem (P, X) of graph. Returns false, leaving nothing
+    // loaded, if it is larger than MAX_LOCAL_VERTICES or too sparse for the
+    // bit matrix to beat sorted arrays (see kernel_select.h).
+    bool build(const CSRGraph& graph, const std::vector<int>& P, const std::vector<int>& X) {
+        return build(graph, P.data(), static_cast<int>(P.size()), X.data(), static_cast<int>(X.size()));
+    }
+
+    bool build(const CSRGraph& graph, const int* P, int pCount, const int* X, int xCount) {
+        candidateCount = pCount;
+        localCount = 0;
+        if (candidateCount > MAX_LOCAL_VERTICES) {
+            PROFILE_COUNT(KERNEL_FALLBACKS, 1);
+            kernelUsage.oversize++;
+            return false;
+        }
+        if (static_cast<int>(localIndex.size()) < graph.vertexCount()) {
+            localIndex.assign(graph.vertexCount(), UNMAPPED);
+        }
+
+        localVertices.assign(P, P + candidateCount);
+        for (int i = 0; i < candidateCount; i++) localIndex[P[i]] = i;
+        for (int i = 0; i < xCount; i++) localIndex[X[i]] = EXCLUDED;
+
+        // An excluded vertex with no neighbor in P can never block a clique
+        // below this level, so only those adjacent to some candidate are kept.
+        keptExcluded.clear();
+        int64_t candidateEdges = 0;
+        for (int i = 0; i < candidateCount; i++) {
+            for (int w : graph.neighbors(P[i])) {
+                candidateEdges += localIndex[w] != UNMAPPED;
+                if (localIndex[w] == EXCLUDED) {
+                    localIndex[w] = candidateCount + static_cast<int>(keptExcluded.size());
+                    keptExcluded.push_back(w);
+                    localVertices.push_back(w);
+                }
+            }
+        }
+        localCount = candidateCount + static_cast<int>(keptExcluded.size());
+        hasStrayExcluded = static_cast<int>(keptExcluded.size()) < xCount;
+
+        bool fits = localCount <= MAX_LOCAL_VERTICES && preferBitset(localCount, candidateCount, candidateEdges);
+        if (fits) {
+            wordCount = (localCount + 63) / 64;
+            rows.assign(static_cast<size_t>(localCount) * wordCount, 0);
+            // Candidate rows carry every local column; an excluded row only
+            // needs its candidate columns, which symmetry fills in here too.
+            for (int i = 0; i < candidateCount; i++) {
+                for (int w : graph.neighbors(P[i])) {
+                    int j = localIndex[w];
+                    if (j < 0) continue;
+                    setBit(row(i), j);
+                    if (j >= candidateCount) setBit(row(j), i);
+                }
+            }
+            if (pivotRule == PIVOT_MAX_DEGREE) {
+                vertexDegree.resize(localCount);
+                for (int i = 0; i < localCount; i++) vertexDegree[i] = graph.degree(localVertices[i]);
+            }
+        }
+
+        for (int i = 0; i < candidateCount; i++) localIndex[P[i]] = UNMAPPED;
+        for (int i = 0; i < xCount; i++) localIndex[X[i]] = UNMAPPED;
+        if (fits) {
+            kernelUsage.bitset++;
+        } else if (localCount <= MAX_LOCAL_VERTICES) {
+            kernelUsage.sparse++;
+        } else {
+            kernelUsage.oversize++;
+        }
+        if (!fits) localCount = 0;
+        PROFILE_COUNT(KERNEL_BUILDS, fits);
+        PROFILE_COUNT(KERNEL_FALLBACKS, !fits);
+        return fits;
+    }
+
+    // Enumerates the maximal cliques of the loaded subproblem, calling
+    // report(size) for each, where size counts the baseSize vertices already
+    // in the clique plus those chosen here. With trackMembers, appendClique()
+    // lists the vertices chosen here during report. Branches that cannot
+    // reach sizeFloor() vertices are cut, and smaller cliques are not
+    // reported; the floor may rise while the enumeration runs.
+    template <bool trackMembers, class Report, class SizeFloor>
+    void enumerate(int baseSize, Report&& report, SizeFloor&& sizeFloor) {
+        chosenCount = 0;
+        if (candidateCount == 0) {
+            if (!hasStrayExcluded && baseSize >= sizeFloor()) report(baseSize);
+            return;
+        }
+        chosen.resize(candidateCount);
+        // Each level moves one candidate into the clique, so the depth never
+        // exceeds the candidate count. Sized up front so no buffer moves.
+        size_t needed = static_cast<size_t>(candidateCount + 1) * 3 * wordCount;
+        if (levels.size() < needed) levels.resize(needed);
+        uint64_t* P = candidates(0);
+        uint64_t* X = excluded(0);
+        for (int w = 0; w < wordCount; w++) P[w] = X[w] = 0;
+        for (int i = 0; i < candidateCount; i++) setBit(P, i);
+        for (int i = candidateCount; i < localCount; i++) setBit(X, i);
+        expand<trackMembers>(0, baseSize, report, sizeFloor);
+    }
+
+    // Appends the graph IDs of the vertices the reported clique adds to the
+    // caller's base clique.
+    void appendClique(std::vector<int>& members) const {
+        for (int k = 0; k < chosenCount; k++) members.push_back(localVertices[chosen[k]]);
+    }
+
+    // Renames the loaded vertices to ids[v], for a subproblem built from a
+    // subgraph whose vertex v is ids[v] in the graph cliques are reported in.
+    void mapVertices(const int* ids) {
+        for (int& v : localVertices) v = ids[v];
+    }
+
+private:
+    enum { UNMAPPED = -1, EXCLUDED = -2 };
+
+    uint64_t* row(int v) { return rows.data() + static_cast<size_t>(v) * wordCount; }
+
+    // Three sets per recursion depth: P, X and the branch vertices.
+    uint64_t* candidates(int depth) { return levels.data() + static_cast<size_t>(depth) * 3 * wordCount; }
+    uint64_t* excluded(int depth) { return candidates(depth) + wordCount; }
+    uint64_t* branches(int depth) { return candidates(depth) + 2 * wordCount; }
+
+    static void setBit(uint64_t* set, int i) { set[i >> 6] |= uint64_t(1) << (i & 63); }
+    static void clearBit(uint64_t* set, int i) { set[i >> 6] &= ~(uint64_t(1) << (i & 63)); }
+
+    template <bool trackMembers, class Report, class SizeFloor>
+    void expand(int depth, int cliqueSize, Report& report, SizeFloor& sizeFloor) {
+        uint64_t* P = candidates(depth);
+        uint64_t* X = excluded(depth);
+        PROFILE_NODE(cliqueSize);
+        nodeCount++;
+
+        int candidateTotal = 0;
+        bool anyExcluded = false;
+        for (int w = 0; w < wordCount; w++) {
+            candidateTotal += __builtin_popcountll(P[w]);
+            anyExcluded |= X[w] != 0;
+        }
+        if (cliqueSize + candidateTotal < sizeFloor()) return;
+        if (candidateTotal == 0) {
+            if (!anyExcluded) {
+                chosenCount = depth;
+                report(cliqueSize);
+            }
+            return;
+        }
+
+        uint64_t* B = branches(depth);
+        const uint64_t* pivotRow = row(choosePivot(P, X, candidateTotal));
+        for (int w = 0; w < wordCount; w++) B[w] = P[w] & ~pivotRow[w];
+
+        uint64_t* nextP = candidates(depth + 1);
+        uint64_t* nextX = excluded(depth + 1);
+
+        for (int w = 0; w < wordCount; w++) {
+            while (B[w]) {
+                int v = (w << 6) + __builtin_ctzll(B[w]);
+                B[w] &= B[w] - 1;
+                const uint64_t* adjacent = row(v);
+                for (int k = 0; k < wordCount; k++) {
+                    nextP[k] = P[k] & adjacent[k];
+                    nextX[k] = X[k] & adjacent[k];
+                }
+                if (trackMembers) chosen[depth] = v;
+                expand<trackMembers>(depth + 1, cliqueSize + 1, report, sizeFloor);
+                clearBit(P, v);
+                setBit(X, v);
+            }
+        }
+    }
+
+    // The pivot of a nonempty P under pivotRule; see pivot_rule.h.
+    int choosePivot(const uint64_t* P, const uint64_t* X, int candidateTotal) {
+        if (pivotRule == PIVOT_FIRST) {
+            int w = 0;
+            while (!P[w]) w++;
+            return (w << 6) + __builtin_ctzll(P[w]);
+        }
+        int pivot = -1;
+        if (pivotRule == PIVOT_MAX_DEGREE) {
+            for (int w = 0; w < wordCount; w++) {
+                for (uint64_t bits = P[w] | X[w]; bits; bits &= bits - 1) {
+                    int u = (w << 6) + __builtin_ctzll(bits);
+                    if (pivot < 0 || vertexDegree[u] > vertexDegree[pivot]) pivot = u;
+                }
+            }
+            return pivot;
+        }
+
+        // Tomita: the vertex of P or X with the most neighbors in P.
+        int bestCover = -1;
+        for (int w = 0; w < wordCount && bestCover < candidateTotal; w++) {
+            uint64_t bits = P[w] | X[w];
+            while (bits && bestCover < candidateTotal) {
+                int u = (w << 6) + __builtin_ctzll(bits);
+                bits &= bits - 1;
+                const uint64_t* adjacent = row(u);
+                PROFILE_COUNT(PIVOT_CANDIDATES, 1);
+                PROFILE_COUNT(PIVOT_WORK, wordCount);
+                int cover = 0;
+                for (int k = 0; k < wordCount; k++) cover += __builtin_popcountll(P[k] & adjacent[k]);
+                if (cover > bestCover) {
+                    bestCover = cover;
+                    pivot = u;
+                }
+            }
+        }
+        return pivot;
+    }
+
+    int candidateCount;
+    int localCount;
+    int wordCount;
+    bool hasStrayExcluded;
+    std::vector<int> localIndex;    // global vertex -> local ID while building
+    std::vector<int> keptExcluded;
+    std::vector<int> localVertices; // local ID -> graph vertex
+    std::vector<int> chosen;        // local IDs added at each depth
+    int chosenCount;
+    std::vector<uint64_t> rows;     // localCount rows of wordCount words
+    std::vector<uint64_t> levels;   // per-depth P, X and branch sets
+    std::vector<int> vertexDegree;  // graph degree per local ID, for PIVOT_MAX_DEGREE
+    KernelUsage kernelUsage;
+    PivotRule pivotRule;
+    int64_t nodeCount;
+};
+
+#endif
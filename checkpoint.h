@@ -0,0 +1,145 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <unistd.h>
+
+#include "csr_graph.h"
+#include "clique_stats.h"
+
+// Progress of a counting enumeration, saved so that an interrupted run can
+// pick up where it stopped. Written in native byte order:
+//
+//   CheckpointHeader
+//   ordering   int32[vertexCount]    search order, under the loaded IDs
+//   histogram  int64[histogramSize]  cliques per size found so far
+//
+// The search order is finished in prefixes, so completedSteps alone says
+// which outer vertices are done; the counts cover exactly those. The order
+// itself is kept because a parallel peel need not reproduce it, and a
+// resumed run has to split the work at the same place.
+
+const char CHECKPOINT_MAGIC[8] = {'C', 'L', 'Q', 'C', 'K', 'P', 'N', 'T'};
+const uint32_t CHECKPOINT_VERSION = 1;
+const uint32_t CHECKPOINT_BYTE_ORDER = 0x01020304;
+
+struct CheckpointHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    int64_t vertexCount;
+    int64_t targetCount;
+    uint64_t graphHash;
+    int64_t minSize;
+    int64_t completedSteps;
+    int64_t totalCliques;
+    int64_t largestCliqueSize;
+    int64_t histogramSize;
+};
+
+struct EnumerationCheckpoint {
+    int64_t vertexCount = 0;
+    int64_t targetCount = 0;
+    uint64_t graphHash = 0;
+    int64_t minSize = 1;
+    std::vector<int> ordering;
+    int64_t completedSteps = 0;  // steps [0, completedSteps) of ordering are done
+    CliqueCounters counters;
+};
+
+// FNV-1a over the degree sequence; with the vertex and edge counts it tells
+// a checkpoint's graph from another one without hashing every edge.
+inline uint64_t checkpointGraphHash(const CSRGraph& graph) {
+    uint64_t hash = 14695981039346656037ull;
+    for (int v = 0; v < graph.vertexCount(); v++) {
+        uint32_t degree = graph.degree(v);
+        for (int b = 0; b < 4; b++) {
+            hash ^= (degree >> (8 * b)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+// Writes the checkpoint under a temporary name, syncs it and renames it
+// into place, so the file on disk is always a complete checkpoint.
+inline bool saveCheckpoint(const std::string& path, const EnumerationCheckpoint& checkpoint, std::string& error) {
+    CheckpointHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    header.version = CHECKPOINT_VERSION;
+    header.byteOrder = CHECKPOINT_BYTE_ORDER;
+    header.vertexCount = checkpoint.vertexCount;
+    header.targetCount = checkpoint.targetCount;
+    header.graphHash = checkpoint.graphHash;
+    header.minSize = checkpoint.minSize;
+    header.completedSteps = checkpoint.completedSteps;
+    header.totalCliques = checkpoint.counters.totalCliques;
+    header.largestCliqueSize = checkpoint.counters.largestCliqueSize;
+    header.histogramSize = checkpoint.counters.sizeDistribution.size();
+
+    std::string temporaryPath = path + ".tmp";
+    FILE* out = fopen(temporaryPath.c_str(), "wb");
+    if (!out) {
+        error = "cannot create " + temporaryPath;
+        return false;
+    }
+    const std::vector<int64_t>& histogram = checkpoint.counters.sizeDistribution;
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1 &&
+              fwrite(checkpoint.ordering.data(), sizeof(int), checkpoint.ordering.size(), out) == checkpoint.ordering.size() &&
+              fwrite(histogram.data(), sizeof(int64_t), histogram.size(), out) == histogram.size();
+    ok = ok && fflush(out) == 0 && fsync(fileno(out)) == 0;
+    ok = (fclose(out) == 0) && ok;
+
+    if (!ok || rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        remove(temporaryPath.c_str());
+        error = "failed writing " + path;
+        return false;
+    }
+    return true;
+}
+
+inline bool loadCheckpoint(const std::string& path, EnumerationCheckpoint& checkpoint, std::string& error) {
+    FILE* in = fopen(path.c_str(), "rb");
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    CheckpointHeader header;
+    bool ok = fread(&header, sizeof(header), 1, in) == 1;
+    if (ok && memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0) {
+        error = path + " is not a checkpoint";
+    } else if (ok && header.version != CHECKPOINT_VERSION) {
+        error = path + " has unsupported checkpoint version " + std::to_string(header.version);
+    } else if (ok && header.byteOrder != CHECKPOINT_BYTE_ORDER) {
+        error = path + " was written with a different byte order";
+    } else if (!ok || header.vertexCount < 0 || header.vertexCount > INT32_MAX || header.completedSteps < 0 ||
+               header.completedSteps > header.vertexCount || header.histogramSize < 0 || header.histogramSize > INT32_MAX) {
+        error = path + " is truncated or corrupt";
+    } else {
+        checkpoint.ordering.resize(header.vertexCount);
+        checkpoint.counters.clear();
+        checkpoint.counters.sizeDistribution.resize(header.histogramSize);
+        ok = fread(checkpoint.ordering.data(), sizeof(int), header.vertexCount, in) == static_cast<size_t>(header.vertexCount) &&
+             fread(checkpoint.counters.sizeDistribution.data(), sizeof(int64_t), header.histogramSize, in) ==
+                 static_cast<size_t>(header.histogramSize);
+        if (!ok) error = path + " is truncated or corrupt";
+    }
+    fclose(in);
+    if (!error.empty()) return false;
+
+    checkpoint.vertexCount = header.vertexCount;
+    checkpoint.targetCount = header.targetCount;
+    checkpoint.graphHash = header.graphHash;
+    checkpoint.minSize = header.minSize;
+    checkpoint.completedSteps = header.completedSteps;
+    checkpoint.counters.totalCliques = header.totalCliques;
+    checkpoint.counters.largestCliqueSize = static_cast<int>(header.largestCliqueSize);
+    return true;
+}
+
+#endif
@@ -1,443 +1,896 @@
 #include <iostream>
 #include <vector>
-#include <set>
-#include <unordered_set>
 #include <algorithm>
-#include <fstream>
-#include <sstream>
 #include <string>
 #include <chrono>
-#include <queue>
-#include <map>
 #include <climits>
 
+#include "csr_graph.h"
+#include "edge_loader.h"
+#include "graph_snapshot.h"
+#include "run_options.h"
+#include "work_stealing.h"
+#include "clique_stats.h"
+#include "bitset_kernel.h"
+#include "kernel_select.h"
+#include "pivot_rule.h"
+#include "ego_subgraph.h"
+#include "vertex_partition.h"
+#include "clique_sink.h"
+#include "clique_visitor.h"
+#include "max_clique.h"
+#include "clique_iterator.h"
+#include "degeneracy.h"
+#include "checkpoint.h"
+#include "profiling.h"
+
 using namespace std;
 using namespace std::chrono;
 
 class MaximalCliquesFinder {
 private:
-    vector<vector<int>> adjacencyList;
+    CSRGraph graph;
+    vector<int> presetOrdering;
     int numVertices;
-    int largestCliqueSize;
-    int totalCliques;
-    map<int, int> cliqueSizeDistribution;
+    int loadThreads;
+    int searchThreads;
+    enum Engine { ENGINE_BK, ENGINE_KOSE, ENGINE_ITERATIVE };
+    Engine engine;
+    bool relabelVertices;
+    vector<int> loadedId;  // loaded ID of each vertex once renumbered
+    vector<int> fileId;    // input file's ID of each loaded vertex, if a snapshot renumbered them
+    vector<int> outputIds; // reported ID of each vertex, for the clique output
+    vector<int> coreNumbers;
+    int minCliqueSize;
+    PivotRule pivotRule;
+    CliqueCounters totals;
+    WorkStealingPool* splitPool;
+    vector<LocalBitGraph> bitKernels;
+    vector<EgoSubgraph> egoGraphs;
+    string checkpointPath;
+    int checkpointInterval;
+    EnumerationCheckpoint checkpoint;  // progress so far, resumed or saved
+    int64_t iteratorNodes;
+
+    // Per-worker state of the in-place search over the worker's ego
+    // subgraph.
+    struct PartitionState {
+        VertexPartition sets;
+        vector<int> branchStack;  // branch vertices of every open frame
+        PivotScores pivotScores;
+        int64_t searchNodes = 0;
+    };
+    vector<PartitionState> partitions;
 
+    // Peels the graph, minimum degree first; the core numbers come with the
+    // ordering and are kept for the size-floor pruning.
     vector<int> computeDegeneracyOrdering() {
-        vector<int> ordering;
-        vector<int> degrees(numVertices);
-        vector<bool> processed(numVertices, false);
-       
-        for (int v = 0; v < numVertices; v++) {
-            degrees[v] = adjacencyList[v].size();
-        }
-       
-        int maxDegree = 0;
-        for (int d : degrees) {
-            maxDegree = max(maxDegree, d);
+        CoreDecomposition cores = decomposeCores(graph, loadThreads);
+        coreNumbers = move(cores.coreNumber);
+        return move(cores.order);
+    }
+
+    // Core numbers of the current graph, peeled here if the ordering came
+    // from a snapshot.
+    const vector<int>& graphCoreNumbers() {
+        if (static_cast<int>(coreNumbers.size()) != numVertices) {
+            coreNumbers = computeCoreNumbers(graph, loadThreads);
         }
-       
-        vector<vector<int>> buckets(maxDegree + 1);
-        for (int v = 0; v < numVertices; v++) {
-            buckets[degrees[v]].push_back(v);
+        return coreNumbers;
+    }
+
+    // The ordering the searches start from. With relabeling on, the first
+    // call renumbers the graph so that this ordering becomes 0..n-1; later
+    // neighbors then follow each vertex in its sorted adjacency and vertices
+    // searched together sit together in memory.
+    vector<int> searchOrdering() {
+        vector<int> ordering = static_cast<int>(presetOrdering.size()) == numVertices ? presetOrdering : computeDegeneracyOrdering();
+        if (!relabelVertices || isRelabeled()) return ordering;
+       
+        vector<int> rank(numVertices);
+        for (int i = 0; i < numVertices; i++) {
+            rank[ordering[i]] = i;
         }
-       
-        for (int d = 0; d <= maxDegree; d++) {
-            while (!buckets[d].empty()) {
-                int v = buckets[d].back();
-                buckets[d].pop_back();
-               
-                if (processed[v]) continue;
-               
-                ordering.push_back(v);
-                processed[v] = true;
-               
-                for (int neighbor : adjacencyList[v]) {
-                    if (!processed[neighbor]) {
-                        int oldDegree = degrees[neighbor];
-                        degrees[neighbor]--;
-                       
-                        if (oldDegree > degrees[neighbor]) {
-                            buckets[degrees[neighbor]].push_back(neighbor);
-                        }
-                    }
-                }
+        graph = graph.relabeled(rank, loadThreads);
+        if (static_cast<int>(coreNumbers.size()) == numVertices) {
+            vector<int> renamed(numVertices);
+            for (int v = 0; v < numVertices; v++) {
+                renamed[rank[v]] = coreNumbers[v];
             }
+            coreNumbers = move(renamed);
         }
-       
-        return ordering;
+        loadedId = move(ordering);
+        presetOrdering.resize(numVertices);
+        for (int i = 0; i < numVertices; i++) {
+            presetOrdering[i] = i;
+        }
+        return presetOrdering;
+    }
+   
+    bool isRelabeled() const { return numVertices > 0 && static_cast<int>(loadedId.size()) == numVertices; }
+   
+    // The ID vertex v is reported under: the one it was loaded with, or the
+    // input file's ID when a snapshot stored that instead.
+    int reportedId(int v) const {
+        if (isRelabeled()) v = loadedId[v];
+        return fileId.empty() ? v : fileId[v];
     }
 
-    vector<int> getNeighborsInSet(int v, const vector<int>& s) {
-        vector<int> result;
-       
-        if (s.size() <= 10) {
-            for (int neighbor : adjacencyList[v]) {
-                if (find(s.begin(), s.end(), neighbor) != s.end()) {
-                    result.push_back(neighbor);
-                }
-            }
-        } else {
-            unordered_set<int> sSet(s.begin(), s.end());
-            for (int neighbor : adjacencyList[v]) {
-                if (sSet.find(neighbor) != sSet.end()) {
-                    result.push_back(neighbor);
-                }
-            }
-        }
-       
-        return result;
+    // A found clique under its reported IDs, ascending.
+    vector<int> reportedClique(vector<int> clique) const {
+        for (int& v : clique) v = reportedId(v);
+        sort(clique.begin(), clique.end());
+        return clique;
+    }
+
+    // Runs a subproblem on the worker's bitset kernel when it fits there,
+    // otherwise on the in-place search over a copy of its ego subgraph. A
+    // large subproblem skips the kernel while other workers are idle so that
+    // its branches can be shared. P and X hold graph IDs.
+    template <class Visitor>
+    void search(int worker, vector<Visitor>& visitors, CliqueTrail<Visitor::needsMembers>& R,
+                const vector<int>& P, const vector<int>& X) {
+        bool split = splitPool && splitPool->shouldSplit(P.size());
+        if (!split && solveInKernel(worker, visitors, R, nullptr, P.data(), P.size(), X.data(), X.size())) return;
+
+        // P is not empty here: the kernel takes every subproblem without
+        // candidates. Queued branches run after this one returns, so the
+        // worker's subgraph is never rebuilt under a search still using it.
+        EgoSubgraph& ego = egoGraphs[worker];
+        ego.build(graph, P.data(), P.size(), X.data(), X.size());
+        PartitionState& s = partitions[worker];
+        s.pivotScores.reset(ego.graph().vertexCount());
+        int beginP, beginR;
+        s.sets.arrange(ego, beginP, beginR);
+        code(worker, visitors, R, 0, beginP, beginR);
     }
 
-    void code(vector<int> R, vector<int> P, vector<int> X) {
-        if (P.empty() && X.empty()) {
-            int cliqueSize = R.size();
-            totalCliques++;
-            cliqueSizeDistribution[cliqueSize]++;
-            largestCliqueSize = max(largestCliqueSize, cliqueSize);
+    // P and X are local IDs of ego when it is given, graph IDs otherwise.
+    template <class Visitor>
+    bool solveInKernel(int worker, vector<Visitor>& visitors, CliqueTrail<Visitor::needsMembers>& R,
+                       const EgoSubgraph* ego, const int* P, int pCount, const int* X, int xCount) {
+        LocalBitGraph& kernel = bitKernels[worker];
+        if (!kernel.build(ego ? ego->graph() : graph, P, pCount, X, xCount)) return false;
+        if (ego && Visitor::needsMembers) kernel.mapVertices(ego->graphIds());
+        enumerateInKernel(kernel, R, visitors[worker], minCliqueSize);
+        return true;
+    }
+
+    // Pivoted Bron-Kerbosch on the ranges X = [beginX, beginP) and
+    // P = [beginP, beginR) of the worker's partition, which each frame leaves
+    // as it found it; scratch space comes from the shared branch stack. The
+    // sets hold local IDs of the worker's ego subgraph; R holds the clique
+    // under graph IDs.
+    template <class Visitor>
+    void code(int worker, vector<Visitor>& visitors, CliqueTrail<Visitor::needsMembers>& R,
+              int beginX, int beginP, int beginR) {
+        PartitionState& s = partitions[worker];
+        const EgoSubgraph& ego = egoGraphs[worker];
+        const CSRGraph& local = ego.graph();
+        if (R.size() + beginR - beginP < searchFloor(visitors[worker], minCliqueSize)) return;
+        PROFILE_NODE(R.size());
+        s.searchNodes++;
+        if (beginP == beginR) {
+            if (beginX == beginP) visitors[worker].visit(R.data(), R.size());
             return;
         }
        
-        vector<int> PUnionX;
-        PUnionX.insert(PUnionX.end(), P.begin(), P.end());
-        PUnionX.insert(PUnionX.end(), X.begin(), X.end());
+        int pivotVertex = s.sets.pivot(pivotRule, local, s.pivotScores, beginX, beginP, beginR);
+        int candidateCount = beginR - beginP;
+       
+        // Gather the pivot's neighbors at the back of P; the vertices in
+        // front of them are the branches.
+        int pivotStart = s.sets.gatherAtBack(local.neighbors(pivotVertex), beginP, beginR);
+        size_t stackBase = s.branchStack.size();
+        for (int i = beginP; i < pivotStart; i++) s.branchStack.push_back(s.sets[i]);
+        size_t stackTop = s.branchStack.size();
        
-        int pivotVertex = -1;
-        int maxIntersectionSize = -1;
+        // Large frame while workers sit idle: queue the remaining branches
+        // instead of walking them here.
+        bool split = splitPool && splitPool->shouldSplit(candidateCount);
        
-        for (int u : PUnionX) {
-            vector<int> neighbors = getNeighborsInSet(u, P);
-            if (static_cast<int>(neighbors.size()) > maxIntersectionSize) {
-                maxIntersectionSize = neighbors.size();
-                pivotVertex = u;
+        for (size_t b = stackBase; b < stackTop; b++) {
+            int v = s.branchStack[b];
+           
+            // Take v out of P, then pull its neighbors to the P/X boundary.
+            s.sets.moveTo(v, --beginR);
+            int newBeginX, newBeginR;
+            s.sets.narrow(local.neighbors(v), beginX, beginP, beginR, newBeginX, newBeginR);
+           
+            R.push(ego.graphId(v));
+            const int* childX = s.sets.at(newBeginX);
+            const int* childP = s.sets.at(beginP);
+            if (split) {
+                CliqueTrail<Visitor::needsMembers> Rprime(R);
+                vector<int> Pprime, Xprime;
+                for (const int* p = childP; p < childP + (newBeginR - beginP); p++) Pprime.push_back(ego.graphId(*p));
+                for (const int* x = childX; x < childX + (beginP - newBeginX); x++) Xprime.push_back(ego.graphId(*x));
+                vector<Visitor>* all = &visitors;
+                splitPool->spawn(worker, [this, all, Rprime, Pprime, Xprime](int w) mutable {
+                    search(w, *all, Rprime, Pprime, Xprime);
+                });
+            } else if (!solveInKernel(worker, visitors, R, &ego, childP, newBeginR - beginP, childX, beginP - newBeginX)) {
+                code(worker, visitors, R, newBeginX, beginP, newBeginR);
             }
+            R.pop();
+           
+            // v joins X; the P vertex it displaces takes v's old slot.
+            s.sets.moveTo(v, beginP++);
+            beginR++;
         }
        
-        vector<int> pivotNeighbors = getNeighborsInSet(pivotVertex, P);
-       
-        vector<int> PCopy = P;
-       
-        for (int v : PCopy) {
-            if (find(pivotNeighbors.begin(), pivotNeighbors.end(), v) == pivotNeighbors.end()) {
-                vector<int> Rprime = R;
-                Rprime.push_back(v);
-               
-                vector<int> Pprime = getNeighborsInSet(v, P);
-                vector<int> Xprime = getNeighborsInSet(v, X);
-               
-                code(Rprime, Pprime, Xprime);
-               
-                P.erase(remove(P.begin(), P.end(), v), P.end());
-                X.push_back(v);
-            }
+        // Return the branch vertices to P so the caller's ranges hold the
+        // same sets as before this frame ran.
+        for (size_t b = stackTop; b > stackBase; b--) {
+            s.sets.moveTo(s.branchStack[b - 1], --beginP);
         }
+        s.branchStack.resize(stackBase);
     }
 
-    void findMaximalCliquesKose() {
-        vector<int> vertexOrder(numVertices);
-        vector<int> S(numVertices, 0);
-        vector<int> T(numVertices, 0);
-        vector<int> C;
-       
+    // Chiba-Nishizeki enumeration (CLIQUE / UPDATE). Vertices are renamed by
+    // rank in nondecreasing degree order, so "y < i" compares ranks. Every
+    // maximal clique C of G[0..i-1] either stays maximal in G[0..i] (when
+    // C - N(i) is nonempty) or is extended to (C ∩ N(i)) ∪ {i}; the latter is
+    // kept only if it is maximal in G[0..i] and C is its lexicographically
+    // largest parent, so each maximal clique of G is reached exactly once.
+    struct KoseState {
+        CSRGraph ranked;           // graph under rank IDs
+        vector<int> members;       // C, in no particular order
+        vector<int> memberSlot;    // position in members, -1 when not in C
+        vector<int> T;             // T[y] = |N(y) ∩ C ∩ N(i)|, y ∉ C, y < i
+        vector<int> S;             // S[y] = |{j ∈ C - N(i) : j < y, j ~ y}|
+        vector<char> adjacentToI;  // marks N(i) during one test
+        vector<char> inGreedy;     // greedy maximal clique of the whole prefix
+        vector<int> greedyBefore;  // greedyBefore[i] = |greedy clique ∩ [0, i)|
+        vector<int> touched;       // y with T[y] > 0
+        vector<int> vertexOfRank;
+        vector<int> vertices;      // C under original IDs, for visitors
+        vector<int> kept;          // C ∩ N(i)
+        vector<int> dropped;       // C - N(i), ascending
+        vector<int> saved;         // stacked SAVE sets of open frames
+    };
+
+    struct KoseFrame {
+        int i;
+        int phase;
+        size_t savedBase;
+    };
+
+    template <class Visitor>
+    void findMaximalCliquesKose(Visitor& visitor) {
         vector<pair<int, int>> degreeVertexPairs;
         for (int i = 0; i < numVertices; i++) {
-            degreeVertexPairs.push_back({adjacencyList[i].size(), i});
+            degreeVertexPairs.push_back({graph.degree(i), i});
         }
         sort(degreeVertexPairs.begin(), degreeVertexPairs.end());
        
+        vector<int> rank(numVertices);
         for (int i = 0; i < numVertices; i++) {
-            vertexOrder[i] = degreeVertexPairs[i].second;
+            rank[degreeVertexPairs[i].second] = i;
         }
+        if (numVertices == 0) return;
        
-        updateKose(2, C, vertexOrder, S, T);
-    }
-   
-    void updateKose(int i, vector<int>& C, const vector<int>& vertexOrder, vector<int>& S, vector<int>& T) {
-        if (i == numVertices + 1) {
-            int cliqueSize = C.size();
-            totalCliques++;
-            cliqueSizeDistribution[cliqueSize]++;
-            largestCliqueSize = max(largestCliqueSize, cliqueSize);
-            return;
-        }
-       
-        int vertex = vertexOrder[i-1];
-       
-        vector<int> intersection = getNeighborsInClique(vertex, C);
-       
-        if (!intersection.empty()) {
-            updateKose(i + 1, C, vertexOrder, S, T);
+        KoseState k;
+        k.ranked = graph.relabeled(rank, loadThreads);
+        k.vertexOfRank.resize(numVertices);
+        for (int i = 0; i < numVertices; i++) {
+            k.vertexOfRank[i] = degreeVertexPairs[i].second;
         }
+        k.memberSlot.assign(numVertices, -1);
+        k.T.assign(numVertices, 0);
+        k.S.assign(numVertices, 0);
+        k.adjacentToI.assign(numVertices, 0);
        
-        computeT(vertex, C, T);
-       
-        computeS(vertex, C, S);
-       
-        bool FLAG = true;
-       
-        FLAG = checkMaximality(vertex, C, T, vertexOrder);
-       
-        if (FLAG) {
-            FLAG = checkLexicographicalOrder(vertex, C, S, T, vertexOrder);
+        // With C ∩ N(i) empty the only parent to keep is the greedy clique
+        // of G[0..i-1], which grows by one vertex at a time.
+        k.inGreedy.assign(numVertices, 0);
+        k.greedyBefore.assign(numVertices + 1, 0);
+        for (int v = 0; v < numVertices; v++) {
+            int greedyNeighbors = 0;
+            for (int w : k.ranked.neighbors(v)) {
+                if (w >= v) break;
+                greedyNeighbors += k.inGreedy[w];
+            }
+            k.inGreedy[v] = greedyNeighbors == k.greedyBefore[v];
+            k.greedyBefore[v + 1] = k.greedyBefore[v] + k.inGreedy[v];
         }
        
-        resetST(vertex, C, S, T);
-       
-        if (FLAG) {
-            vector<int> SAVE = getDifference(C, getNeighborsInSet(vertex, C));
-            C = getUnion(intersection, {vertex});
-            updateKose(i + 1, C, vertexOrder, S, T);
-            C = getUnion(getDifference(C, {vertex}), SAVE);
-        }
+        addToClique(k, 0);
+        PROFILE_PHASE(SEARCH);
+        updateKose(k, 1, visitor);
     }
    
-    vector<int> getNeighborsInClique(int v, const vector<int>& clique) {
-        vector<int> result;
-        for (int u : clique) {
-            if (find(adjacencyList[v].begin(), adjacencyList[v].end(), u) != adjacencyList[v].end()) {
-                result.push_back(u);
+    // UPDATE(start, C) with an explicit stack; the recursion is n levels deep.
+    template <class Visitor>
+    void updateKose(KoseState& k, int start, Visitor& visitor) {
+        vector<KoseFrame> stack;
+        stack.push_back({start, 0, 0});
+        while (!stack.empty()) {
+            KoseFrame& frame = stack.back();
+            int i = frame.i;
+            if (i == numVertices) {
+                // No size pruning here; small cliques are only left unreported.
+                int size = k.members.size();
+                if (size >= minCliqueSize && Visitor::needsMembers) {
+                    k.vertices.clear();
+                    for (int v : k.members) k.vertices.push_back(k.vertexOfRank[v]);
+                    visitor.visit(k.vertices.data(), size);
+                } else if (size >= minCliqueSize) {
+                    visitor.visit(nullptr, size);
+                }
+                stack.pop_back();
+                continue;
             }
-        }
-        return result;
-    }
-   
-    void computeT(int vertex, const vector<int>& C, vector<int>& T) {
-        vector<int> intersection = getNeighborsInClique(vertex, C);
-        for (int x : intersection) {
-            for (int y : adjacencyList[x]) {
-                if (find(C.begin(), C.end(), y) == C.end() && y != vertex) {
-                    T[y]++;
+           
+            if (frame.phase == 0) {
+                PROFILE_NODE(k.members.size());
+                // Line 1: C stays maximal in G[0..i] unless C ⊆ N(i).
+                frame.phase = 1;
+                if (countNeighborsInClique(k, i) < static_cast<int>(k.members.size())) {
+                    stack.push_back({i + 1, 0, 0});
+                }
+            } else if (frame.phase == 1) {
+                // Lines 2-10: try C' = (C ∩ N(i)) ∪ {i}.
+                frame.phase = 2;
+                if (!testKoseCandidate(k, i)) {
+                    stack.pop_back();
+                    continue;
                 }
+                frame.savedBase = k.saved.size();
+                for (int j : k.dropped) {
+                    k.saved.push_back(j);
+                    removeFromClique(k, j);
+                }
+                addToClique(k, i);
+                stack.push_back({i + 1, 0, 0});
+            } else {
+                // Restore C = (C' - {i}) ∪ SAVE.
+                removeFromClique(k, i);
+                for (size_t s = frame.savedBase; s < k.saved.size(); s++) {
+                    addToClique(k, k.saved[s]);
+                }
+                k.saved.resize(frame.savedBase);
+                stack.pop_back();
             }
         }
     }
    
-    void computeS(int vertex, const vector<int>& C, vector<int>& S) {
-        vector<int> difference;
-        for (int x : C) {
-            if (find(adjacencyList[vertex].begin(), adjacencyList[vertex].end(), x) == adjacencyList[vertex].end()) {
-                difference.push_back(x);
-            }
-        }
-       
-        for (int x : difference) {
-            for (int y : adjacencyList[x]) {
-                if (find(C.begin(), C.end(), y) == C.end()) {
-                    S[y]++;
-                }
-            }
-        }
+    static void addToClique(KoseState& k, int v) {
+        k.memberSlot[v] = k.members.size();
+        k.members.push_back(v);
     }
    
-    bool checkMaximality(int vertex, const vector<int>& C, const vector<int>& T, const vector<int>& vertexOrder) {
-        int intersectionSize = getNeighborsInClique(vertex, C).size();
-       
-        for (int y : adjacencyList[vertex]) {
-            if (find(C.begin(), C.end(), y) == C.end() &&
-                getVertexIndex(y, vertexOrder) < getVertexIndex(vertex, vertexOrder) &&
-                T[y] == intersectionSize) {
-                return false;
-            }
-        }
-       
-        return true;
+    static void removeFromClique(KoseState& k, int v) {
+        int slot = k.memberSlot[v];
+        int last = k.members.back();
+        k.members[slot] = last;
+        k.memberSlot[last] = slot;
+        k.members.pop_back();
+        k.memberSlot[v] = -1;
     }
    
-    bool checkLexicographicalOrder(int vertex, const vector<int>& C, const vector<int>& S, const vector<int>& T, const vector<int>& vertexOrder) {
-        return true;
+    // |C ∩ N(i)|; C only holds vertices ranked below i.
+    int countNeighborsInClique(const KoseState& k, int i) {
+        int count = 0;
+        for (int w : k.ranked.neighbors(i)) {
+            if (w >= i) break;
+            count += k.memberSlot[w] >= 0;
+        }
+        return count;
     }
    
-    void resetST(int vertex, const vector<int>& C, vector<int>& S, vector<int>& T) {
-        vector<int> intersection = getNeighborsInClique(vertex, C);
-        for (int x : intersection) {
-            for (int y : adjacencyList[x]) {
-                if (find(C.begin(), C.end(), y) == C.end() && y != vertex) {
-                    T[y] = 0;
-                }
-            }
-        }
-       
-        vector<int> difference;
-        for (int x : C) {
-            if (find(adjacencyList[vertex].begin(), adjacencyList[vertex].end(), x) == adjacencyList[vertex].end()) {
-                difference.push_back(x);
-            }
+    // True when (C ∩ N(i)) ∪ {i} is a maximal clique of G[0..i] and C is the
+    // lexicographically largest maximal clique of G[0..i-1] containing
+    // C ∩ N(i). Leaves C - N(i) in k.dropped.
+    bool testKoseCandidate(KoseState& k, int i) {
+        NeighborRange adjacent = k.ranked.neighbors(i);
+        for (int w : adjacent) k.adjacentToI[w] = 1;
+        k.kept.clear();
+        k.dropped.clear();
+        for (int x : k.members) {
+            (k.adjacentToI[x] ? k.kept : k.dropped).push_back(x);
+        }
+        sort(k.dropped.begin(), k.dropped.end());
+       
+        computeT(k, i);
+        bool FLAG = checkMaximality(k, i);
+        if (FLAG) {
+            FLAG = checkLexicographicalOrder(k, i);
         }
-       
-        for (int x : difference) {
-            for (int y : adjacencyList[x]) {
-                if (find(C.begin(), C.end(), y) == C.end()) {
-                    S[y] = 0;
-                }
+        resetST(k);
+        for (int w : adjacent) k.adjacentToI[w] = 0;
+        return FLAG;
+    }
+   
+    // Line 2: T[y] for y < i outside C.
+    void computeT(KoseState& k, int i) {
+        for (int x : k.kept) {
+            for (int y : k.ranked.neighbors(x)) {
+                if (y >= i) break;
+                if (k.memberSlot[y] >= 0) continue;
+                if (k.T[y]++ == 0) k.touched.push_back(y);
             }
         }
     }
    
-    int getVertexIndex(int vertex, const vector<int>& vertexOrder) {
-        for (int i = 0; i < numVertices; i++) {
-            if (vertexOrder[i] == vertex) {
-                return i;
+    // Line 3, restricted to the vertices the lexicographic test looks at:
+    // S[y] counts the dropped vertices below y adjacent to y, for every y
+    // adjacent to all of C ∩ N(i).
+    void computeS(KoseState& k, int i) {
+        int keptCount = k.kept.size();
+        for (int j : k.dropped) {
+            for (int y : k.ranked.neighbors(j)) {
+                if (y >= i) break;
+                if (y > j && k.memberSlot[y] < 0 && k.T[y] == keptCount) k.S[y]++;
             }
         }
-        return -1;
     }
    
-    vector<int> getDifference(const vector<int>& A, const vector<int>& B) {
-        vector<int> result;
-        for (int a : A) {
-            if (find(B.begin(), B.end(), a) == B.end()) {
-                result.push_back(a);
-            }
+    // Line 4: some y < i outside C, adjacent to i and to all of C ∩ N(i),
+    // would extend (C ∩ N(i)) ∪ {i}.
+    bool checkMaximality(const KoseState& k, int i) {
+        if (k.kept.empty()) {
+            NeighborRange adjacent = k.ranked.neighbors(i);
+            return adjacent.empty() || adjacent[0] > i;
+        }
+        int keptCount = k.kept.size();
+        for (int y : k.touched) {
+            if (k.T[y] == keptCount && k.adjacentToI[y]) return false;
         }
-        return result;
+        return true;
     }
    
-    vector<int> getUnion(const vector<int>& A, const vector<int>& B) {
-        vector<int> result = A;
-        for (int b : B) {
-            if (find(result.begin(), result.end(), b) == result.end()) {
-                result.push_back(b);
+    // Lines 5-7. The lexicographically largest maximal clique containing
+    // K = C ∩ N(i) is built greedily from K by ascending rank, so C is it
+    // unless some y ∉ C, y < i, adjacent to all of K, is also adjacent to
+    // every dropped vertex below it: greedy would take y first.
+    bool checkLexicographicalOrder(KoseState& k, int i) {
+        if (k.kept.empty()) {
+            if (static_cast<int>(k.members.size()) != k.greedyBefore[i]) return false;
+            for (int x : k.members) {
+                if (!k.inGreedy[x]) return false;
             }
+            return true;
         }
-        return result;
+        computeS(k, i);
+        int keptCount = k.kept.size();
+        for (int y : k.touched) {
+            if (k.T[y] != keptCount) continue;
+            int droppedBelow = lower_bound(k.dropped.begin(), k.dropped.end(), y) - k.dropped.begin();
+            if (k.S[y] == droppedBelow) return false;
+        }
+        return true;
     }
-
-    void addEdge(int u, int v) {
-        if (u < 0 || v < 0 || u >= numVertices || v >= numVertices) return;
-        if (find(adjacencyList[u].begin(), adjacencyList[u].end(), v) == adjacencyList[u].end()) {
-            adjacencyList[u].push_back(v);
-            adjacencyList[v].push_back(u);
+   
+    // Lines 8-9.
+    void resetST(KoseState& k) {
+        for (int y : k.touched) {
+            k.T[y] = 0;
+            k.S[y] = 0;
         }
+        k.touched.clear();
     }
 
 public:
-    MaximalCliquesFinder() : numVertices(0), largestCliqueSize(0), totalCliques(0) {}
-   
-    void loadGraphFromFile(const string& filename) {
-        ifstream infile(filename);
-        if (!infile) {
-            cerr << "Error opening file: " << filename << endl;
-            return;
+    MaximalCliquesFinder() : numVertices(0), loadThreads(1), searchThreads(1), engine(ENGINE_BK), relabelVertices(false), minCliqueSize(1), pivotRule(PIVOT_TOMITA), splitPool(nullptr), checkpointInterval(0), iteratorNodes(0) {}
+
+    void setThreads(int loading, int searching) {
+        loadThreads = max(1, loading);
+        searchThreads = max(1, searching);
+    }
+
+    // Cliques smaller than size are neither reported nor searched for.
+    void setMinimumSize(int size) {
+        minCliqueSize = max(1, size);
+    }
+
+    // Renumber the graph by degeneracy rank before the first search (bk and
+    // iterative engines).
+    void setRelabel(bool enabled) {
+        relabelVertices = enabled;
+    }
+
+    // Pivot rule of the bk engine, in the general search and the kernel, and
+    // of the iterative engine.
+    void setPivotRule(PivotRule rule) {
+        pivotRule = rule;
+    }
+
+    // "bk" (pivoted Bron-Kerbosch, the default), "kose" (Chiba-Nishizeki,
+    // serial) or "iterative" (pivoted Bron-Kerbosch pulled one clique at a
+    // time through MaximalCliqueIterator, serial). Returns false for any
+    // other name.
+    bool setEngine(const string& name) {
+        if (name == "bk") {
+            engine = ENGINE_BK;
+        } else if (name == "kose") {
+            engine = ENGINE_KOSE;
+        } else if (name == "iterative") {
+            engine = ENGINE_ITERATIVE;
+        } else {
+            return false;
         }
+        return true;
+    }
 
-        string line;
-        int edges = 0;
-        bool header_found = false;
+    // Has the next counting enumeration save its progress to path about
+    // every intervalSeconds. With resume, a checkpoint already at path is
+    // picked up: its finished vertices are skipped and its counts carried
+    // over. Call after loading the graph; returns false if the checkpoint
+    // cannot be read or belongs to another graph or size floor.
+    bool setCheckpoint(const string& path, int intervalSeconds, bool resume) {
+        checkpointPath = path;
+        checkpointInterval = max(1, intervalSeconds);
+        checkpoint = EnumerationCheckpoint();
+        checkpoint.vertexCount = numVertices;
+        checkpoint.targetCount = graph.directedEdgeCount();
+        checkpoint.graphHash = checkpointGraphHash(graph);
+        checkpoint.minSize = minCliqueSize;
+        if (!resume) return true;
+        if (access(path.c_str(), F_OK) != 0) {
+            cout << "No checkpoint at " << path << ", starting from the beginning." << endl;
+            return true;
+        }
 
-        while (getline(infile, line)) {
-            if (line.empty() || line[0] == '#') {
-                if (line.find("Nodes:") != string::npos && line.find("Edges:") != string::npos) {
-                    stringstream ss(line);
-                    string temp;
-                    ss >> temp >> temp >> numVertices >> temp >> edges;
-                    header_found = true;
-                }
-                continue;
+        EnumerationCheckpoint saved;
+        string error;
+        if (!loadCheckpoint(path, saved, error)) {
+            cerr << "Error loading checkpoint: " << error << endl;
+            return false;
+        }
+        if (saved.vertexCount != checkpoint.vertexCount || saved.targetCount != checkpoint.targetCount ||
+            saved.graphHash != checkpoint.graphHash) {
+            cerr << "Error: checkpoint " << path << " was written for a different graph" << endl;
+            return false;
+        }
+        if (saved.minSize != checkpoint.minSize) {
+            cerr << "Error: checkpoint " << path << " was written with --min-size " << saved.minSize << endl;
+            return false;
+        }
+        vector<char> seen(numVertices, 0);
+        for (int v : saved.ordering) {
+            if (v < 0 || v >= numVertices || seen[v]) {
+                cerr << "Error: checkpoint " << path << " is truncated or corrupt" << endl;
+                return false;
             }
-            break;
+            seen[v] = 1;
         }
 
-        if (!header_found) {
-            infile.clear();
-            infile.seekg(0, ios::beg);
-            if (getline(infile, line)) {
-                stringstream ss(line);
-                if (ss >> numVertices >> edges) {
-                    header_found = true;
-                }
-            }
+        // The search must go through the vertices in the saved order for
+        // its finished prefix to mean the same vertices.
+        presetOrdering = saved.ordering;
+        checkpoint = move(saved);
+        cout << "Resuming from " << path << ": " << checkpoint.completedSteps << " of " << numVertices
+             << " vertices done, " << checkpoint.counters.totalCliques << " cliques so far." << endl;
+        return true;
+    }
+   
+    bool loadGraphFromFile(const string& filename) {
+        PROFILE_PHASE(LOAD);
+        presetOrdering.clear();
+        loadedId.clear();
+        fileId.clear();
+        coreNumbers.clear();
+        if (isGraphSnapshot(filename)) {
+            return loadGraphFromSnapshot(filename);
+        }
+
+        EdgeListData data;
+        if (!loadEdgeList(filename, data, true, loadThreads)) {
+            cerr << "Error opening file: " << filename << endl;
+            return false;
         }
 
-        if (!header_found) {
+        if (!data.headerFound) {
             cerr << "Could not find header with node and edge count!" << endl;
-            return;
+            return false;
         }
 
-        if (numVertices <= 0) {
-            cerr << "Invalid number of nodes: " << numVertices << endl;
-            return;
+        if (data.declaredNodes <= 0 || data.declaredNodes > INT_MAX) {
+            cerr << "Invalid number of nodes: " << data.declaredNodes << endl;
+            return false;
         }
+        numVertices = static_cast<int>(data.declaredNodes);
+
+        graph = CSRGraph::fromEdgeBlocks(numVertices, data.edgeBlocks, loadThreads);
+        cout << "Loaded graph with " << numVertices << " nodes and " << data.edgeLines << " edges." << endl;
+        return true;
+    }
+
+    bool loadGraphFromSnapshot(const string& filename) {
+        GraphSnapshot snapshot;
+        string error;
+        if (!loadGraphSnapshot(filename, snapshot, error)) {
+            cerr << "Error loading snapshot: " << error << endl;
+            return false;
+        }
+
+        graph = move(snapshot.graph);
+        numVertices = graph.vertexCount();
+        presetOrdering = move(snapshot.ordering);
+        fileId = move(snapshot.originalIds);
+        cout << "Loaded graph with " << numVertices << " nodes and " << graph.edgeCount() << " edges." << endl;
+        return true;
+    }
 
-        adjacencyList.clear();
-        adjacencyList.resize(numVertices);
+    bool saveGraphToSnapshot(const string& filename) {
+        if (presetOrdering.empty()) {
+            presetOrdering = computeDegeneracyOrdering();
+        }
 
-        infile.clear();
-        infile.seekg(0, ios::beg);
+        string error;
+        if (!saveGraphSnapshot(filename, graph, &presetOrdering, fileId.empty() ? nullptr : &fileId, error)) {
+            cerr << "Error saving snapshot: " << error << endl;
+            return false;
+        }
+        cout << "Saved graph snapshot to " << filename << endl;
+        return true;
+    }
+   
+    // Pivoted Bron-Kerbosch from each vertex of a degeneracy ordering
+    template <class Visitor>
+    void findMaximalCliquesBK(vector<Visitor>& visitors) {
+        bitKernels.assign(searchThreads, LocalBitGraph());
+        for (LocalBitGraph& kernel : bitKernels) kernel.setPivotRule(pivotRule);
+        partitions.assign(searchThreads, PartitionState());
+        egoGraphs.clear();
+        egoGraphs.resize(searchThreads);
+       
+        vector<int> ordering = searchOrdering();
+        bool relabeled = isRelabeled();
+       
+        vector<int> orderingIndex;
+        if (!relabeled) {
+            orderingIndex.resize(numVertices);
+            for (int i = 0; i < numVertices; i++) {
+                orderingIndex[ordering[i]] = i;
+            }
+        }
        
-        int edgeCount = 0;
-        bool skipHeader = true;
+        // Cliques of at least floor vertices lie in the (floor - 1)-core, so
+        // with a size floor the rest of the graph is never touched.
+        const vector<int> unused;
+        const vector<int>& coreNumber = minCliqueSize > 1 || Visitor::boundsSize ? graphCoreNumbers() : unused;
        
-        while (getline(infile, line)) {
-            if (line.empty() || line[0] == '#') continue;
-            if (line.find("Nodes:") != string::npos && line.find("Edges:") != string::npos) continue;
-            if (line.find("FromNodeId") != string::npos) continue;
+        // A visitor that raises its size floor as it goes wants the dense
+        // end of the ordering first.
+        auto processVertex = [&](int64_t step, int worker) {
+            PROFILE_ROOT();
+            int64_t i = Visitor::boundsSize ? numVertices - 1 - step : step;
+            int v = ordering[i];
+            int floor = searchFloor(visitors[worker], minCliqueSize);
+            auto skipped = [&](int u) { return !coreNumber.empty() && coreNumber[u] < floor - 1; };
+            if (skipped(v)) return;
            
-            if (skipHeader) {
-                stringstream ss(line);
-                int n, e;
-                if (ss >> n >> e && n == numVertices) {
-                    skipHeader = false;
-                    continue;
+            vector<int> P, X;
+            if (relabeled) {
+                // v == i: the two halves of its adjacency are X and P
+                NeighborRange later = graph.laterNeighbors(v);
+                NeighborRange earlier = graph.earlierNeighbors(v);
+                if (coreNumber.empty()) {
+                    P.assign(later.begin(), later.end());
+                    X.assign(earlier.begin(), earlier.end());
+                } else {
+                    copy_if(later.begin(), later.end(), back_inserter(P), [&](int u) { return !skipped(u); });
+                    copy_if(earlier.begin(), earlier.end(), back_inserter(X), [&](int u) { return !skipped(u); });
+                }
+            } else {
+                for (int neighbor : graph.neighbors(v)) {
+                    if (orderingIndex[neighbor] > i && !skipped(neighbor)) {
+                        P.push_back(neighbor);
+                    }
+                }
+               
+                for (int neighbor : graph.neighbors(v)) {
+                    if (orderingIndex[neighbor] < i && !skipped(neighbor)) {
+                        X.push_back(neighbor);
+                    }
                 }
-                skipHeader = false;
             }
            
-            stringstream ss(line);
-            int u, v;
-            if (ss >> u >> v) {
-                addEdge(u, v);
-                edgeCount++;
+            if (1 + static_cast<int>(P.size()) < floor) return;
+           
+            CliqueTrail<Visitor::needsMembers> R(&v, &v + 1);
+            search(worker, visitors, R, P, X);
+        };
+       
+        PROFILE_PHASE(SEARCH);
+        WorkStealingPool pool(searchThreads);
+        int64_t grain = max<int64_t>(1, min<int64_t>(256, numVertices / (searchThreads * 64)));
+        auto runSteps = [&](int64_t begin, int64_t end) {
+            if (searchThreads == 1) {
+                for (int64_t i = begin; i < end; i++) {
+                    processVertex(i, 0);
+                }
+            } else {
+                spawnRange(pool, begin, end, grain, processVertex);
+                splitPool = &pool;
+                pool.run();
+                splitPool = nullptr;
+            }
+        };
+        if (checkpointPath.empty()) {
+            runSteps(0, numVertices);
+            return;
+        }
+
+        // Checkpoints fall between segments of the ordering, each finished
+        // before the next starts, so the counts saved cover exactly the
+        // steps before the boundary. Segments are sized to take a small
+        // part of the interval: long enough that waiting for the last
+        // worker at each boundary costs little, short enough that a save
+        // is never far behind the interval.
+        checkpoint.ordering = relabeled ? loadedId : ordering;
+        auto lastSave = steady_clock::now();
+        auto interval = seconds(checkpointInterval);
+        int64_t segment = searchThreads * grain;
+        while (checkpoint.completedSteps < numVertices) {
+            int64_t begin = checkpoint.completedSteps;
+            int64_t end = min<int64_t>(numVertices, begin + segment);
+            auto segmentStart = steady_clock::now();
+            runSteps(begin, end);
+            auto now = steady_clock::now();
+            if (now - segmentStart < interval / 16) {
+                segment *= 2;
+            } else if (now - segmentStart > interval / 4) {
+                segment = max<int64_t>(1, segment / 2);
+            }
+
+            checkpoint.completedSteps = end;
+            if (end == numVertices || now - lastSave >= interval) {
+                saveProgress(visitors);
+                lastSave = steady_clock::now();
             }
         }
+    }
 
-        infile.close();
-        cout << "Loaded graph with " << numVertices << " nodes and " << edgeCount << " edges." << endl;
+    // Writes checkpoint with the visitors' counts added to those resumed.
+    // A failed save is reported and the run goes on; the previous
+    // checkpoint stays in place.
+    template <class Visitor>
+    void saveProgress(const vector<Visitor>& visitors) {
+        EnumerationCheckpoint progress = checkpoint;
+        for (const Visitor& visitor : visitors) {
+            visitor.addTo(progress.counters);
+        }
+        string error;
+        if (!saveCheckpoint(checkpointPath, progress, error)) {
+            cerr << "Warning: checkpoint not saved: " << error << endl;
+        }
     }
-   
-    void findMaximalCliques() {
-        largestCliqueSize = 0;
-        totalCliques = 0;
-        cliqueSizeDistribution.clear();
+
+    // Drains a MaximalCliqueIterator over the search ordering into visitor.
+    // The search keeps its frames on the heap, so clique size and search
+    // depth are not limited by the call stack.
+    template <class Visitor>
+    void findMaximalCliquesIterative(Visitor& visitor) {
+        MaximalCliqueIterator cliques(graph, searchOrdering(), minCliqueSize, pivotRule);
+        PROFILE_PHASE(SEARCH);
+        vector<int> clique;
+        while (cliques.next(clique)) {
+            visitor.visit(clique.data(), clique.size());
+        }
+        iteratorNodes = cliques.searchNodes();
+    }
+
+    // Runs the selected engine with one visitor per search thread and sums
+    // their counts into totals.
+    template <class Visitor>
+    void enumerateWith(vector<Visitor>& visitors) {
+        if (engine == ENGINE_KOSE) {
+            findMaximalCliquesKose(visitors[0]);
+        } else if (engine == ENGINE_ITERATIVE) {
+            findMaximalCliquesIterative(visitors[0]);
+        } else {
+            findMaximalCliquesBK(visitors);
+        }
+        for (const Visitor& visitor : visitors) {
+            visitor.addTo(totals);
+        }
+    }
+
+    // Branch and bound for the largest clique alone; the clique also goes to
+    // out, if given.
+    void findMaximumClique(CliqueSink* out = nullptr) {
+        auto startTime = high_resolution_clock::now();
+       
+        vector<int> ordering = searchOrdering();
+        MaxCliqueSearch search(graph, ordering, searchThreads, &graphCoreNumbers());
+        vector<int> clique = reportedClique(search.run());
+       
+        auto endTime = high_resolution_clock::now();
+        auto duration = duration_cast<microseconds>(endTime - startTime);
        
+        if (out && !clique.empty()) out->write(0, clique.data(), clique.size());
+        cout << "1. Largest Clique Size: " << clique.size() << endl;
+        cout << "2. Maximum Clique:";
+        for (int v : clique) {
+            cout << " " << v;
+        }
+        cout << endl;
+        cout << "3. Execution Time: " << duration.count() / 1000.0 << " ms" << endl;
+    }
+
+    // The count largest maximal cliques, found with a shared bounded heap
+    // whose floor prunes the search; they also go to out, if given.
+    void findTopCliques(int count, CliqueSink* out = nullptr) {
         auto startTime = high_resolution_clock::now();
        
-        vector<int> ordering = computeDegeneracyOrdering();
+        TopCliques top(count);
+        vector<TopCliqueVisitor> visitors(searchThreads, TopCliqueVisitor(&top));
+        findMaximalCliquesBK(visitors);
+        vector<vector<int>> cliques = top.results();
+        for (vector<int>& clique : cliques) {
+            clique = reportedClique(clique);
+        }
        
-        vector<int> orderingIndex(numVertices);
-        for (int i = 0; i < numVertices; i++) {
-            orderingIndex[ordering[i]] = i;
+        auto endTime = high_resolution_clock::now();
+        auto duration = duration_cast<microseconds>(endTime - startTime);
+       
+        cout << "1. Largest Clique Size: " << (cliques.empty() ? 0 : cliques[0].size()) << endl;
+        cout << "2. Top " << cliques.size() << " Maximal Cliques:" << endl;
+        for (const vector<int>& clique : cliques) {
+            if (out) out->write(0, clique.data(), clique.size());
+            cout << "   - Size " << clique.size() << ":";
+            for (int v : clique) {
+                cout << " " << v;
+            }
+            cout << endl;
         }
+        cout << "3. Execution Time: " << duration.count() / 1000.0 << " ms" << endl;
+    }
+
+    // Cliques are also written to out, if given, which must be open with
+    // at least as many worker buffers as search threads. Otherwise only
+    // sizes are tracked.
+    void findMaximalCliques(CliqueSink* out = nullptr) {
+        totals = checkpoint.counters;
        
-        for (int i = 0; i < numVertices; i++) {
-            int v = ordering[i];
-           
-            vector<int> P;
-            for (int neighbor : adjacencyList[v]) {
-                if (orderingIndex[neighbor] > i) {
-                    P.push_back(neighbor);
-                }
+        auto startTime = high_resolution_clock::now();
+       
+        if (out) {
+            // Relabeling happens before the first clique is written
+            if (relabelVertices && engine != ENGINE_KOSE) {
+                searchOrdering();
             }
-           
-            vector<int> X;
-            for (int neighbor : adjacencyList[v]) {
-                if (orderingIndex[neighbor] < i) {
-                    X.push_back(neighbor);
+            if (isRelabeled() || !fileId.empty()) {
+                outputIds.resize(numVertices);
+                for (int v = 0; v < numVertices; v++) {
+                    outputIds[v] = reportedId(v);
                 }
+                out->setIdMap(&outputIds);
             }
-           
-            vector<int> R = {v};
-            code(R, P, X);
+            vector<CliqueSinkVisitor> visitors;
+            for (int w = 0; w < searchThreads; w++) {
+                visitors.emplace_back(out, w);
+            }
+            enumerateWith(visitors);
+        } else {
+            vector<CliqueHistogramVisitor> visitors(searchThreads);
+            enumerateWith(visitors);
         }
        
         auto endTime = high_resolution_clock::now();
-        auto duration = duration_cast<milliseconds>(endTime - startTime);
+        auto duration = duration_cast<microseconds>(endTime - startTime);
        
-        cout << "1. Largest Clique Size: " << largestCliqueSize << endl;
-        cout << "2. Total Number of Maximal Cliques: " << totalCliques << endl;
-        cout << "3. Execution Time: " << duration.count() << " ms" << endl;
+        cout << "1. Largest Clique Size: " << totals.largestCliqueSize << endl;
+        cout << "2. Total Number of Maximal Cliques: " << totals.totalCliques << endl;
+        cout << "3. Execution Time: " << duration.count() / 1000.0 << " ms" << endl;
         cout << "4. Distribution of Clique Sizes:" << endl;
        
-        for (int i = 1; i <= largestCliqueSize; i++) {
-            cout << "   - Cliques of size " << i << ": " << (cliqueSizeDistribution.count(i) ? cliqueSizeDistribution[i] : 0) << endl;
+        for (int i = 1; i <= totals.largestCliqueSize; i++) {
+            cout << "   - Cliques of size " << i << ": " << totals.count(i) << endl;
+        }
+        if (engine == ENGINE_ITERATIVE) {
+            cout << "5. Search Tree Nodes: " << iteratorNodes << " (" << pivotRuleName(pivotRule) << " pivots)" << endl;
+        } else if (engine == ENGINE_BK) {
+            KernelUsage usage;
+            for (const LocalBitGraph& kernel : bitKernels) usage.merge(kernel.usage());
+            cout << "5. Subproblem Engines: ";
+            printKernelUsage(cout, usage);
+            int64_t nodes = 0;
+            for (int w = 0; w < searchThreads; w++) nodes += bitKernels[w].searchNodes() + partitions[w].searchNodes;
+            cout << "6. Search Tree Nodes: " << nodes << " (" << pivotRuleName(pivotRule) << " pivots)" << endl;
         }
     }
 };
@@ -445,13 +898,53 @@ public:
 int main(int argc, char* argv[]) {
     MaximalCliquesFinder finder;
    
-    string filename = "Email-Enron.txt";
-    if (argc > 1) {
-        filename = argv[1];
+    RunOptions options;
+    if (!parseRunOptions(argc, argv, options)) {
+        return 1;
+    }
+    kernelSelection();  // calibrate on this host before anything is timed
+    finder.setThreads(options.loadThreads(), options.searchThreads());
+    finder.setMinimumSize(options.minSize);
+    finder.setRelabel(options.relabel);
+    finder.setPivotRule(options.pivotRule);
+    if (!finder.setEngine(options.engine)) {
+        cerr << "Unknown engine: " << options.engine << endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (options.topCount > 0 && options.engine != "bk") {
+        cerr << "--top needs the bk engine" << endl;
+        return 1;
+    }
+    if (!options.checkpointFile.empty() &&
+        (options.engine != "bk" || options.maxClique || options.topCount > 0 || !options.outputFile.empty())) {
+        cerr << "--checkpoint needs the bk engine counting cliques, without --output, --top or --max-clique" << endl;
+        return 1;
+    }
+    CliqueSink sink;
+    if (!openCliqueOutput(options, sink)) {
+        return 1;
     }
    
-    finder.loadGraphFromFile(filename);
-    finder.findMaximalCliques();
+    if (!finder.loadGraphFromFile(options.inputFile)) {
+        return 1;
+    }
+    if (!options.snapshotOutput.empty() && !finder.saveGraphToSnapshot(options.snapshotOutput)) {
+        return 1;
+    }
+    if (!options.checkpointFile.empty() &&
+        !finder.setCheckpoint(options.checkpointFile, options.checkpointInterval, options.resume)) {
+        return 1;
+    }
+    if (options.maxClique) {
+        finder.findMaximumClique(sink.isOpen() ? &sink : nullptr);
+    } else if (options.topCount > 0) {
+        finder.findTopCliques(options.topCount, sink.isOpen() ? &sink : nullptr);
+    } else {
+        finder.findMaximalCliques(sink.isOpen() ? &sink : nullptr);
+    }
+    if (!closeCliqueOutput(options, sink)) return 1;
+    PROFILE_REPORT();
    
     return 0;
-}
\ No newline at end of file
+}
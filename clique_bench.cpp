@@ -0,0 +1,434 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <cstdint>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#include "graph_generators.h"
+
+using namespace std;
+using namespace std::chrono;
+
+// Runs every clique finder on a set of seeded synthetic graphs and reports
+// median and p95 times, peak memory and throughput, then checks that all
+// engines found the same cliques. The finders are separate programs, so each
+// run is a child process; its search time is the one it reports itself, and
+// its peak RSS comes from wait4().
+//
+// Usage: clique_bench [options]
+//   --bin-dir DIR      where the chiba, els-algo and tomita-algo binaries are (default .)
+//   --engines LIST     comma-separated subset of bk,kose,iterative,els,tomita (default all)
+//   --graphs LIST      comma-separated subset of er,ba,moon-moser,planted,rmat (default all)
+//   --vertices N       vertex count of the random graphs (default 2000)
+//   --seed S           generator seed (default 1)
+//   --warmup W         untimed runs per engine and graph (default 1)
+//   --repeat R         timed runs per engine and graph (default 5)
+//   --threads N        passed on to the engines
+//   --format FORMAT    csv (default) or json
+//   --work-dir DIR     where the generated edge lists go (default .)
+// Exits with status 1 if any engine fails or the engines disagree.
+
+struct BenchEngine {
+    string name;
+    string binary;
+    vector<string> arguments;
+};
+
+struct BenchOptions {
+    string binDir = ".";
+    vector<string> engines = {"bk", "kose", "iterative", "els", "tomita"};
+    vector<string> graphs = {"er", "ba", "moon-moser", "planted", "rmat"};
+    int vertices = 2000;
+    uint64_t seed = 1;
+    int warmup = 1;
+    int repeat = 5;
+    int threads = 0;
+    string format = "csv";
+    string workDir = ".";
+};
+
+// What one engine reported for one graph, over all timed runs.
+struct BenchResult {
+    string graph;
+    int vertices = 0;
+    size_t edges = 0;
+    string engine;
+    bool ok = false;
+    int64_t cliques = 0;
+    vector<int64_t> histogram;  // cliques per size, as reported
+    int largest = 0;
+    double medianMs = 0, p95Ms = 0, wallMedianMs = 0;
+    long peakRssKb = 0;
+    string status;
+};
+
+static vector<string> splitList(const string& text) {
+    vector<string> items;
+    stringstream stream(text);
+    string item;
+    while (getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+static bool parseBenchOptions(int argc, char* argv[], BenchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Bad argument: " << arg << endl;
+            return false;
+        }
+        string value = argv[++i];
+        if (arg == "--bin-dir") {
+            options.binDir = value;
+        } else if (arg == "--engines") {
+            options.engines = splitList(value);
+        } else if (arg == "--graphs") {
+            options.graphs = splitList(value);
+        } else if (arg == "--vertices") {
+            options.vertices = max(2, atoi(value.c_str()));
+        } else if (arg == "--seed") {
+            options.seed = strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--warmup") {
+            options.warmup = max(0, atoi(value.c_str()));
+        } else if (arg == "--repeat") {
+            options.repeat = max(1, atoi(value.c_str()));
+        } else if (arg == "--threads") {
+            options.threads = max(0, atoi(value.c_str()));
+        } else if (arg == "--format" && (value == "csv" || value == "json")) {
+            options.format = value;
+        } else if (arg == "--work-dir") {
+            options.workDir = value;
+        } else {
+            cerr << "Bad argument: " << arg << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool makeEngine(const string& name, const BenchOptions& options, BenchEngine& engine) {
+    engine.name = name;
+    if (name == "bk") {
+        engine.binary = "chiba";
+    } else if (name == "kose") {
+        engine.binary = "chiba";
+        engine.arguments = {"--engine", "kose"};
+    } else if (name == "iterative") {
+        engine.binary = "chiba";
+        engine.arguments = {"--engine", "iterative"};
+    } else if (name == "els") {
+        engine.binary = "els-algo";
+    } else if (name == "tomita") {
+        engine.binary = "tomita-algo";
+    } else {
+        return false;
+    }
+    engine.binary = options.binDir + "/" + engine.binary;
+    if (options.threads > 0) {
+        engine.arguments.push_back("--threads");
+        engine.arguments.push_back(to_string(options.threads));
+    }
+    return true;
+}
+
+// Sizes scale with --vertices; Moon-Moser stays small since its output grows
+// as 3^(n/3).
+static bool makeGraph(const string& name, const BenchOptions& options, GeneratedGraph& graph) {
+    int n = options.vertices;
+    if (name == "er") {
+        graph = graphgen::erdosRenyi(n, min(1.0, 20.0 / n), options.seed);
+    } else if (name == "ba") {
+        graph = graphgen::barabasiAlbert(n, 8, options.seed);
+    } else if (name == "moon-moser") {
+        graph = graphgen::moonMoser(min(12, n / 3));
+    } else if (name == "planted") {
+        graph = graphgen::plantedCliques(n, min(1.0, 10.0 / n), max(1, n / 200), 12, options.seed);
+    } else if (name == "rmat") {
+        int scale = 1;
+        while ((1 << (scale + 1)) <= n) scale++;
+        graph = graphgen::rmat(scale, 8, options.seed);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Number following the first of labels found in output, or -1.
+static int64_t reportedValue(const string& output, const vector<string>& labels) {
+    for (const string& label : labels) {
+        size_t at = output.find(label);
+        if (at != string::npos) return strtoll(output.c_str() + at + label.size(), nullptr, 10);
+    }
+    return -1;
+}
+
+// Clique counts by size from the "Cliques of size K: N" (chiba, els-algo)
+// or "Size K: N cliques" (tomita-algo) lines of output.
+static vector<int64_t> reportedHistogram(const string& output) {
+    vector<int64_t> histogram;
+    stringstream lines(output);
+    string line;
+    while (getline(lines, line)) {
+        size_t at = line.find_first_not_of(" -");
+        if (at == string::npos) continue;
+        const char* text = line.c_str() + at;
+        if (strncmp(text, "Cliques of size ", 16) == 0) {
+            text += 16;
+        } else if (strncmp(text, "Size ", 5) == 0) {
+            text += 5;
+        } else {
+            continue;
+        }
+        char* end = nullptr;
+        long size = strtol(text, &end, 10);
+        if (end == text || *end != ':' || size < 0) continue;
+        if (size >= static_cast<long>(histogram.size())) histogram.resize(size + 1, 0);
+        histogram[size] = strtoll(end + 1, nullptr, 10);
+    }
+    return histogram;
+}
+
+// The part of a histogram every finder reports: the Tomita finder does not
+// list isolated vertices, and zero counts may or may not be printed.
+static vector<int64_t> comparableHistogram(vector<int64_t> histogram) {
+    for (size_t size = 0; size < histogram.size() && size < 2; size++) histogram[size] = 0;
+    while (!histogram.empty() && histogram.back() == 0) histogram.pop_back();
+    return histogram;
+}
+
+static int64_t countOfSize(const vector<int64_t>& histogram, size_t size) {
+    return size < histogram.size() ? histogram[size] : 0;
+}
+
+// Milliseconds following the first of labels found in output, or -1. The
+// finders print fractional milliseconds.
+static double reportedTime(const string& output, const vector<string>& labels) {
+    for (const string& label : labels) {
+        size_t at = output.find(label);
+        if (at != string::npos) return strtod(output.c_str() + at + label.size(), nullptr);
+    }
+    return -1;
+}
+
+// Runs binary with arguments, capturing stdout. Returns false if it could not
+// be started or did not exit cleanly.
+static bool runChild(const string& binary, const vector<string>& arguments, string& output, double& wallMs,
+                     long& peakRssKb) {
+    int pipeEnds[2];
+    if (pipe(pipeEnds) != 0) return false;
+    auto start = steady_clock::now();
+    pid_t child = fork();
+    if (child < 0) {
+        close(pipeEnds[0]);
+        close(pipeEnds[1]);
+        return false;
+    }
+    if (child == 0) {
+        dup2(pipeEnds[1], STDOUT_FILENO);
+        close(pipeEnds[0]);
+        close(pipeEnds[1]);
+        int devNull = open("/dev/null", O_WRONLY);
+        if (devNull >= 0) dup2(devNull, STDERR_FILENO);
+        vector<char*> argv;
+        argv.push_back(const_cast<char*>(binary.c_str()));
+        for (const string& argument : arguments) argv.push_back(const_cast<char*>(argument.c_str()));
+        argv.push_back(nullptr);
+        execv(binary.c_str(), argv.data());
+        _exit(127);
+    }
+
+    close(pipeEnds[1]);
+    output.clear();
+    char buffer[4096];
+    ssize_t got;
+    while ((got = read(pipeEnds[0], buffer, sizeof(buffer))) > 0) output.append(buffer, got);
+    close(pipeEnds[0]);
+
+    int status = 0;
+    struct rusage usage;
+    if (wait4(child, &status, 0, &usage) != child) return false;
+    wallMs = duration<double, milli>(steady_clock::now() - start).count();
+    peakRssKb = usage.ru_maxrss;
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// Nearest-rank percentile of an unsorted sample.
+static double percentile(vector<double> values, double fraction) {
+    sort(values.begin(), values.end());
+    size_t rank = static_cast<size_t>(ceil(fraction * values.size()));
+    return values[min(values.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+static BenchResult benchmark(const BenchEngine& engine, const string& graphFile, const BenchOptions& options) {
+    BenchResult result;
+    result.engine = engine.name;
+    if (access(engine.binary.c_str(), X_OK) != 0) {
+        result.status = "missing binary " + engine.binary;
+        return result;
+    }
+
+    vector<string> arguments = {graphFile};
+    arguments.insert(arguments.end(), engine.arguments.begin(), engine.arguments.end());
+    vector<double> searchTimes, wallTimes;
+    for (int run = 0; run < options.warmup + options.repeat; run++) {
+        string output;
+        double wallMs = 0;
+        long rssKb = 0;
+        if (!runChild(engine.binary, arguments, output, wallMs, rssKb)) {
+            result.status = "run failed";
+            return result;
+        }
+        double searchMs = reportedTime(output, {"Execution Time:", "Execution time:"});
+        int64_t cliques = reportedValue(output, {"Total Number of Maximal Cliques:", "Number of cliques:"});
+        int64_t largest = reportedValue(output, {"Largest Clique Size:", "Maximum clique size:"});
+        vector<int64_t> histogram = reportedHistogram(output);
+        if (searchMs < 0 || cliques < 0 || largest < 0) {
+            result.status = "unrecognized output";
+            return result;
+        }
+        if (run > 0 && (cliques != result.cliques || largest != result.largest || histogram != result.histogram)) {
+            result.status = "counts changed between runs";
+            return result;
+        }
+        result.cliques = cliques;
+        result.largest = static_cast<int>(largest);
+        result.histogram = histogram;
+        result.peakRssKb = max(result.peakRssKb, rssKb);
+        if (run >= options.warmup) {
+            searchTimes.push_back(searchMs);
+            wallTimes.push_back(wallMs);
+        }
+    }
+    result.medianMs = percentile(searchTimes, 0.5);
+    result.p95Ms = percentile(searchTimes, 0.95);
+    result.wallMedianMs = percentile(wallTimes, 0.5);
+    result.ok = true;
+    result.status = "ok";
+    return result;
+}
+
+// Marks every result of one graph whose size histogram differs from that of
+// the first engine that ran. The Tomita finder does not report isolated
+// vertices, so size-1 cliques are left out of the comparison.
+static bool crossCheck(vector<BenchResult>& results, size_t first) {
+    const BenchResult* reference = nullptr;
+    bool agree = true;
+    for (size_t i = first; i < results.size(); i++) {
+        BenchResult& result = results[i];
+        if (!result.ok) continue;
+        if (!reference) {
+            reference = &result;
+            continue;
+        }
+        vector<int64_t> found = comparableHistogram(result.histogram);
+        vector<int64_t> expected = comparableHistogram(reference->histogram);
+        if (found != expected || result.largest != reference->largest) {
+            result.status = "mismatch with " + reference->engine;
+            agree = false;
+            size_t size = 2;
+            while (size < max(found.size(), expected.size()) && countOfSize(found, size) == countOfSize(expected, size)) {
+                size++;
+            }
+            cerr << result.graph << ": " << result.engine << " found " << countOfSize(found, size) << " cliques of size "
+                 << size << " (largest " << result.largest << "), " << reference->engine << " found "
+                 << countOfSize(expected, size) << " (largest " << reference->largest << ")" << endl;
+        }
+    }
+    return agree;
+}
+
+static double cliquesPerSecond(const BenchResult& result) {
+    return result.medianMs > 0 ? result.cliques * 1000.0 / result.medianMs : 0;
+}
+
+static void printCsv(const vector<BenchResult>& results) {
+    cout << "graph,vertices,edges,engine,median_ms,p95_ms,wall_median_ms,peak_rss_kb,cliques,largest,cliques_per_sec,status"
+         << endl;
+    cout << fixed << setprecision(3);
+    for (const BenchResult& r : results) {
+        cout << r.graph << "," << r.vertices << "," << r.edges << "," << r.engine << "," << r.medianMs << ","
+             << r.p95Ms << "," << r.wallMedianMs << "," << r.peakRssKb << "," << r.cliques << "," << r.largest
+             << "," << cliquesPerSecond(r) << ",\"" << r.status << "\"" << endl;
+    }
+}
+
+static void printJson(const vector<BenchResult>& results) {
+    cout << fixed << setprecision(3) << "[" << endl;
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        cout << "  {\"graph\": \"" << r.graph << "\", \"vertices\": " << r.vertices << ", \"edges\": " << r.edges
+             << ", \"engine\": \"" << r.engine << "\", \"median_ms\": " << r.medianMs << ", \"p95_ms\": " << r.p95Ms
+             << ", \"wall_median_ms\": " << r.wallMedianMs << ", \"peak_rss_kb\": " << r.peakRssKb
+             << ", \"cliques\": " << r.cliques << ", \"largest\": " << r.largest
+             << ", \"cliques_per_sec\": " << cliquesPerSecond(r) << ", \"status\": \"" << r.status << "\"}"
+             << (i + 1 < results.size() ? "," : "") << endl;
+    }
+    cout << "]" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!parseBenchOptions(argc, argv, options)) return 1;
+
+    vector<BenchEngine> engines;
+    for (const string& name : options.engines) {
+        BenchEngine engine;
+        if (!makeEngine(name, options, engine)) {
+            cerr << "Unknown engine: " << name << endl;
+            return 1;
+        }
+        engines.push_back(engine);
+    }
+
+    vector<BenchResult> results;
+    bool allOk = true;
+    for (const string& graphName : options.graphs) {
+        GeneratedGraph graph;
+        if (!makeGraph(graphName, options, graph)) {
+            cerr << "Unknown graph: " << graphName << endl;
+            return 1;
+        }
+        string graphFile = options.workDir + "/bench_" + graphName + ".txt";
+        if (!writeEdgeList(graph, graphFile)) {
+            cerr << "Error writing " << graphFile << endl;
+            return 1;
+        }
+        cerr << "Graph " << graphName << ": " << graph.vertexCount << " vertices, " << graph.edges.size() << " edges"
+             << endl;
+
+        size_t first = results.size();
+        for (const BenchEngine& engine : engines) {
+            BenchResult result = benchmark(engine, graphFile, options);
+            result.graph = graphName;
+            result.vertices = graph.vertexCount;
+            result.edges = graph.edges.size();
+            if (!result.ok) {
+                allOk = false;
+                cerr << graphName << ": " << engine.name << " " << result.status << endl;
+            }
+            results.push_back(result);
+        }
+        allOk &= crossCheck(results, first);
+        unlink(graphFile.c_str());
+    }
+
+    if (options.format == "json") {
+        printJson(results);
+    } else {
+        printCsv(results);
+    }
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+#ifndef CLIQUE_ITERATOR_H
+#define CLIQUE_ITERATOR_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "csr_graph.h"
+#include "ego_subgraph.h"
+#include "pivot_rule.h"
+#include "vertex_partition.h"
+#include "profiling.h"
+
+// Pull-based enumeration of the maximal cliques of a graph:
+//
+//   MaximalCliqueIterator cliques(graph, ordering);
+//   std::vector<int> clique;
+//   while (cliques.next(clique)) { ... }
+//
+// Each next() runs pivoted Bron-Kerbosch only until it finds one more
+// clique, so the caller can stop at any point or do other work between
+// calls. The search keeps its frames on an explicit stack instead of the
+// call stack, and so has no depth limit. Like the in-place search in chiba,
+// every outer vertex of the ordering is searched on a copy of its ego
+// subgraph, with X and P kept in a VertexPartition. The graph must
+// outlive the iterator. Serial; one iterator per thread.
+class MaximalCliqueIterator {
+public:
+    // Cliques smaller than minSize are skipped, and so is every subtree that
+    // cannot reach minSize vertices.
+    MaximalCliqueIterator(const CSRGraph& graph, std::vector<int> ordering, int minSize = 1,
+                          PivotRule rule = PIVOT_TOMITA)
+        : graph(graph), ordering(std::move(ordering)), minSize(std::max(1, minSize)), pivotRule(rule),
+          nextStep(0), nodeCount(0) {
+        orderingIndex.resize(this->ordering.size());
+        for (size_t i = 0; i < this->ordering.size(); i++) {
+            orderingIndex[this->ordering[i]] = static_cast<int>(i);
+        }
+    }
+
+    // Puts the next maximal clique in clique, under graph IDs in ascending
+    // order. Returns false once every clique has been returned.
+    bool next(std::vector<int>& clique) {
+        for (;;) {
+            if (frames.empty()) {
+                if (nextStep == static_cast<int>(ordering.size())) return false;
+                if (startVertex(ordering[nextStep++])) break;
+                continue;
+            }
+
+            // Arriving here with a branch taken means its subtree is done:
+            // v joins X and the P vertex it displaces takes v's old slot.
+            Frame& frame = frames.back();
+            if (frame.nextBranch > frame.firstBranch) {
+                int v = branchStack[frame.nextBranch - 1];
+                members.pop_back();
+                sets.moveTo(v, frame.beginP++);
+                frame.beginR++;
+            }
+            if (frame.nextBranch == frame.endBranch) {
+                // Return the branch vertices to P so the parent's ranges
+                // hold the same sets as before this frame ran.
+                for (size_t b = frame.endBranch; b > frame.firstBranch; b--) {
+                    sets.moveTo(branchStack[b - 1], --frame.beginP);
+                }
+                branchStack.resize(frame.firstBranch);
+                frames.pop_back();
+                continue;
+            }
+
+            // Take the next branch v out of P, then pull its neighbors to
+            // the P/X boundary.
+            int v = branchStack[frame.nextBranch++];
+            sets.moveTo(v, --frame.beginR);
+            int childBeginX, childBeginR;
+            sets.narrow(ego.graph().neighbors(v), frame.beginX, frame.beginP, frame.beginR, childBeginX, childBeginR);
+            members.push_back(ego.graphId(v));
+            if (enter(childBeginX, frame.beginP, childBeginR)) break;
+        }
+
+        clique = members;
+        std::sort(clique.begin(), clique.end());
+        return true;
+    }
+
+    // Search-tree nodes expanded so far.
+    int64_t searchNodes() const { return nodeCount; }
+
+private:
+    // One open Bron-Kerbosch frame: X = [beginX, beginP) and
+    // P = [beginP, beginR) of sets, and its branch vertices at
+    // [firstBranch, endBranch) of branchStack, taken up to nextBranch.
+    struct Frame {
+        int beginX;
+        int beginP;
+        int beginR;
+        size_t firstBranch;
+        size_t nextBranch;
+        size_t endBranch;
+    };
+
+    // Sets up the search from v over its later neighbors P and earlier
+    // neighbors X. Returns true if {v} alone is a clique to report.
+    bool startVertex(int v) {
+        PROFILE_ROOT();
+        int i = orderingIndex[v];
+        candidates.clear();
+        excluded.clear();
+        for (int w : graph.neighbors(v)) {
+            (orderingIndex[w] > i ? candidates : excluded).push_back(w);
+        }
+        members.assign(1, v);
+        if (candidates.empty()) {
+            nodeCount++;
+            return excluded.empty() && minSize <= 1;
+        }
+        if (1 + static_cast<int>(candidates.size()) < minSize) return false;
+
+        ego.build(graph, candidates.data(), candidates.size(), excluded.data(), excluded.size());
+        int localCount = ego.graph().vertexCount();
+        pivotScores.reset(localCount);
+        int beginP, beginR;
+        sets.arrange(ego, beginP, beginR);
+        // Every frame takes at least one candidate, so the depth never
+        // exceeds the candidate count.
+        frames.reserve(ego.candidates().size() + 1);
+        branchStack.reserve(localCount);
+        return enter(0, beginP, beginR);
+    }
+
+    // Opens a frame over X = [beginX, beginP) and P = [beginP, beginR) with
+    // members as its clique. Returns true instead if members is a maximal
+    // clique to report; a frame is pushed only when it has branches.
+    bool enter(int beginX, int beginP, int beginR) {
+        if (static_cast<int>(members.size()) + beginR - beginP < minSize) return false;
+        PROFILE_NODE(members.size());
+        nodeCount++;
+        if (beginP == beginR) return beginX == beginP;
+
+        // Gather the pivot's neighbors at the back of P; the vertices in
+        // front of them are the branches.
+        const CSRGraph& local = ego.graph();
+        int pivotVertex = sets.pivot(pivotRule, local, pivotScores, beginX, beginP, beginR);
+        int pivotStart = sets.gatherAtBack(local.neighbors(pivotVertex), beginP, beginR);
+        size_t firstBranch = branchStack.size();
+        for (int i = beginP; i < pivotStart; i++) branchStack.push_back(sets[i]);
+        frames.push_back({beginX, beginP, beginR, firstBranch, firstBranch, branchStack.size()});
+        return false;
+    }
+
+    const CSRGraph& graph;
+    std::vector<int> ordering;
+    std::vector<int> orderingIndex;  // position of each vertex in ordering
+    int minSize;
+    PivotRule pivotRule;
+    int nextStep;                    // next outer vertex, as a position in ordering
+    int64_t nodeCount;
+
+    EgoSubgraph ego;                 // subgraph of the current outer vertex
+    std::vector<int> candidates;     // its P and X under graph IDs
+    std::vector<int> excluded;
+    std::vector<int> members;        // current clique, graph IDs
+    std::vector<Frame> frames;
+    std::vector<int> branchStack;    // branch vertices of every open frame
+    VertexPartition sets;            // X and P of the open frames, local IDs
+    PivotScores pivotScores;
+};
+
+#endif
@@ -0,0 +1,203 @@
+#ifndef CLIQUE_SINK_H
+#define CLIQUE_SINK_H
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+
+// Streams maximal cliques to a file or stdout. Each worker appends to its own
+// buffer; full buffers are handed to a background thread that does the
+// writing, so enumeration only blocks when the writer falls far behind.
+//
+// Members of each clique are written in ascending order, after mapping
+// through the optional ID table. Formats:
+//   text    one clique per line, members separated by spaces
+//   binary  per clique: varint size, varint first member, then varint
+//           differences between consecutive members (LEB128 varints)
+class CliqueSink {
+public:
+    enum Format { TEXT, BINARY };
+
+    CliqueSink() : out(nullptr), ownsFile(false), format(TEXT), idMap(nullptr),
+                   stopping(false), writeFailed(false) {}
+    ~CliqueSink() { close(); }
+
+    CliqueSink(const CliqueSink&) = delete;
+    CliqueSink& operator=(const CliqueSink&) = delete;
+
+    // Parses "text" or "binary".
+    static bool parseFormat(const std::string& name, Format& result) {
+        if (name == "text") {
+            result = TEXT;
+        } else if (name == "binary") {
+            result = BINARY;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // Opens path for writing ("-" is stdout) with one buffer per worker.
+    bool open(const std::string& path, Format outputFormat, int workers, std::string& error) {
+        close();
+        if (path == "-") {
+            out = stdout;
+            ownsFile = false;
+        } else {
+            out = fopen(path.c_str(), "wb");
+            ownsFile = true;
+            if (!out) {
+                error = "cannot create " + path;
+                return false;
+            }
+        }
+        format = outputFormat;
+        stopping = false;
+        writeFailed = false;
+        buffers.clear();
+        for (int w = 0; w < std::max(1, workers); w++) {
+            buffers.emplace_back(new WorkerBuffer());
+            buffers.back()->data.reserve(FLUSH_BYTES + SLACK_BYTES);
+        }
+        writer = std::thread([this]() { writerLoop(); });
+        return true;
+    }
+
+    bool isOpen() const { return out != nullptr; }
+
+    // Output IDs become ids[v] instead of v. The table must outlive the sink.
+    void setIdMap(const std::vector<int>* ids) { idMap = ids; }
+
+    void write(int worker, const int* members, int size) {
+        WorkerBuffer& buffer = *buffers[worker];
+        std::vector<int>& sorted = buffer.scratch;
+        sorted.resize(size);
+        for (int k = 0; k < size; k++) sorted[k] = idMap ? (*idMap)[members[k]] : members[k];
+        std::sort(sorted.begin(), sorted.end());
+
+        std::string& data = buffer.data;
+        if (format == TEXT) {
+            char digits[12];
+            for (int k = 0; k < size; k++) {
+                if (k > 0) data.push_back(' ');
+                int length = 0;
+                unsigned value = static_cast<unsigned>(sorted[k]);
+                do {
+                    digits[length++] = static_cast<char>('0' + value % 10);
+                    value /= 10;
+                } while (value);
+                while (length > 0) data.push_back(digits[--length]);
+            }
+            data.push_back('\n');
+        } else {
+            appendVarint(data, static_cast<uint32_t>(size));
+            uint32_t previous = 0;
+            for (int k = 0; k < size; k++) {
+                uint32_t value = static_cast<uint32_t>(sorted[k]);
+                appendVarint(data, value - previous);
+                previous = value;
+            }
+        }
+        if (data.size() >= FLUSH_BYTES) submit(buffer);
+    }
+
+    // Writes everything still buffered and stops the writer. Returns false if
+    // any write failed.
+    bool close() {
+        if (!out) return true;
+        for (auto& buffer : buffers) {
+            if (!buffer->data.empty()) submit(*buffer);
+        }
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        queueChanged.notify_all();
+        writer.join();
+
+        bool ok = !writeFailed && fflush(out) == 0;
+        if (ownsFile) ok = (fclose(out) == 0) && ok;
+        out = nullptr;
+        buffers.clear();
+        spare.clear();
+        return ok;
+    }
+
+private:
+    static const size_t FLUSH_BYTES = size_t(1) << 20;
+    static const size_t SLACK_BYTES = 4096;
+
+    struct alignas(64) WorkerBuffer {
+        std::string data;
+        std::vector<int> scratch;
+    };
+
+    static void appendVarint(std::string& data, uint32_t value) {
+        while (value >= 0x80) {
+            data.push_back(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        data.push_back(static_cast<char>(value));
+    }
+
+    // Queues a worker's buffer and gives the worker an empty one. Waits while
+    // too many buffers are queued so memory stays bounded.
+    void submit(WorkerBuffer& buffer) {
+        std::string full;
+        full.swap(buffer.data);
+        std::unique_lock<std::mutex> guard(lock);
+        queueChanged.wait(guard, [&]() { return pending.size() < maxPending(); });
+        pending.push_back(std::move(full));
+        if (!spare.empty()) {
+            buffer.data.swap(spare.back());
+            spare.pop_back();
+        }
+        guard.unlock();
+        queueChanged.notify_all();
+        if (buffer.data.capacity() < FLUSH_BYTES) buffer.data.reserve(FLUSH_BYTES + SLACK_BYTES);
+    }
+
+    size_t maxPending() const { return 2 * buffers.size() + 2; }
+
+    void writerLoop() {
+        std::unique_lock<std::mutex> guard(lock);
+        for (;;) {
+            queueChanged.wait(guard, [&]() { return stopping || !pending.empty(); });
+            if (pending.empty()) break;
+            std::string data;
+            data.swap(pending.front());
+            pending.pop_front();
+            guard.unlock();
+            queueChanged.notify_all();
+
+            if (!writeFailed && fwrite(data.data(), 1, data.size(), out) != data.size()) writeFailed = true;
+            data.clear();
+
+            guard.lock();
+            if (spare.size() < buffers.size()) spare.push_back(std::move(data));
+        }
+    }
+
+    FILE* out;
+    bool ownsFile;
+    Format format;
+    const std::vector<int>* idMap;
+    std::vector<std::unique_ptr<WorkerBuffer>> buffers;
+
+    std::thread writer;
+    std::mutex lock;
+    std::condition_variable queueChanged;
+    std::deque<std::string> pending;   // full buffers, oldest first
+    std::vector<std::string> spare;    // emptied buffers for reuse
+    bool stopping;
+    bool writeFailed;
+};
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef CLIQUE_STATS_H
+#define CLIQUE_STATS_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "profiling.h"
+
+// Clique totals and size histogram. Each worker fills its own copy; the
+// copies are merged once enumeration ends.
+struct CliqueCounters {
+    int64_t totalCliques = 0;
+    int largestCliqueSize = 0;
+    std::vector<int64_t> sizeDistribution;  // indexed by clique size
+
+    void record(int size) {
+        PROFILE_COUNT(CLIQUES_RECORDED, 1);
+        totalCliques++;
+        if (size >= static_cast<int>(sizeDistribution.size())) sizeDistribution.resize(size + 1, 0);
+        sizeDistribution[size]++;
+        largestCliqueSize = std::max(largestCliqueSize, size);
+    }
+
+    int64_t count(int size) const {
+        return size < static_cast<int>(sizeDistribution.size()) ? sizeDistribution[size] : 0;
+    }
+
+    void merge(const CliqueCounters& other) {
+        totalCliques += other.totalCliques;
+        largestCliqueSize = std::max(largestCliqueSize, other.largestCliqueSize);
+        if (other.sizeDistribution.size() > sizeDistribution.size()) {
+            sizeDistribution.resize(other.sizeDistribution.size(), 0);
+        }
+        for (size_t size = 0; size < other.sizeDistribution.size(); size++) {
+            sizeDistribution[size] += other.sizeDistribution[size];
+        }
+    }
+
+    void clear() { *this = CliqueCounters(); }
+};
+
+#endif
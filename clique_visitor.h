@@ -0,0 +1,181 @@
+#ifndef CLIQUE_VISITOR_H
+#define CLIQUE_VISITOR_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+#include "clique_stats.h"
+#include "clique_sink.h"
+#include "bitset_kernel.h"
+
+// Compile-time policies for what happens to each maximal clique. The search
+// engines are templates over a visitor type:
+//
+//   static const bool needsMembers;
+//   void visit(const int* members, int size);  // members is null unless
+//                                              // needsMembers is true
+//   void addTo(CliqueCounters& totals) const;  // fold into a run summary
+//   static const bool boundsSize;              // true if sizeFloor() can
+//   int sizeFloor() const;                     // rise above 0 during a run
+//
+// When needsMembers is false the engines keep the current clique as a
+// depth counter only (CliqueTrail<false>) and never store or copy members.
+// When boundsSize is true they skip any subtree that cannot produce a
+// clique of sizeFloor() vertices, and start from the dense end of the
+// ordering so the floor rises early. Each worker owns one visitor; addTo()
+// merges them after the search.
+
+// Defaults for visitors that want every clique.
+struct UnboundedVisitor {
+    static const bool boundsSize = false;
+    int sizeFloor() const { return 0; }
+};
+
+// Totals plus the size histogram.
+struct CliqueHistogramVisitor : UnboundedVisitor {
+    static const bool needsMembers = false;
+    CliqueCounters counters;
+
+    void visit(const int*, int size) { counters.record(size); }
+    void addTo(CliqueCounters& totals) const { totals.merge(counters); }
+};
+
+// Writes every clique to a sink through the buffer of one worker.
+struct CliqueSinkVisitor : UnboundedVisitor {
+    static const bool needsMembers = true;
+    CliqueCounters counters;
+    CliqueSink* sink;
+    int worker;
+
+    CliqueSinkVisitor(CliqueSink* output, int workerIndex) : sink(output), worker(workerIndex) {}
+
+    void visit(const int* clique, int size) {
+        counters.record(size);
+        sink->write(worker, clique, size);
+    }
+
+    void addTo(CliqueCounters& totals) const { totals.merge(counters); }
+};
+
+// The k largest maximal cliques seen so far, shared by all workers. Once k
+// are held, a clique must be strictly larger than the smallest of them to
+// enter, so ties at the k-th size go to whichever was found first.
+class TopCliques {
+public:
+    explicit TopCliques(int count) : capacity(std::max(1, count)), floor(1) {}
+
+    // Smallest size that can still enter.
+    int sizeFloor() const { return floor.load(std::memory_order_relaxed); }
+
+    void offer(const int* members, int size) {
+        if (size < sizeFloor()) return;
+        std::lock_guard<std::mutex> guard(lock);
+        if (size < floor.load(std::memory_order_relaxed)) return;
+        if (static_cast<int>(heap.size()) == capacity) {
+            std::pop_heap(heap.begin(), heap.end(), largerFirst);
+            heap.pop_back();
+        }
+        heap.emplace_back(members, members + size);
+        std::push_heap(heap.begin(), heap.end(), largerFirst);
+        if (static_cast<int>(heap.size()) == capacity) {
+            floor.store(static_cast<int>(heap.front().size()) + 1, std::memory_order_relaxed);
+        }
+    }
+
+    // The cliques held, largest first, each with members ascending.
+    std::vector<std::vector<int>> results() const {
+        std::vector<std::vector<int>> sorted(heap);
+        for (auto& clique : sorted) std::sort(clique.begin(), clique.end());
+        std::stable_sort(sorted.begin(), sorted.end(),
+                         [](const std::vector<int>& a, const std::vector<int>& b) { return a.size() > b.size(); });
+        return sorted;
+    }
+
+private:
+    // Heap order with the smallest clique on top.
+    static bool largerFirst(const std::vector<int>& a, const std::vector<int>& b) { return a.size() > b.size(); }
+
+    int capacity;
+    std::atomic<int> floor;
+    std::mutex lock;
+    std::vector<std::vector<int>> heap;
+};
+
+// Feeds a shared TopCliques and prunes against its floor.
+struct TopCliqueVisitor {
+    static const bool needsMembers = true;
+    static const bool boundsSize = true;
+    TopCliques* top;
+
+    explicit TopCliqueVisitor(TopCliques* shared) : top(shared) {}
+
+    void visit(const int* clique, int size) { top->offer(clique, size); }
+    int sizeFloor() const { return top->sizeFloor(); }
+    void addTo(CliqueCounters&) const {}
+};
+
+// Smallest clique size a search still has to reach: minSize, raised to the
+// visitor's floor when it has one.
+template <class Visitor>
+int searchFloor(const Visitor& visitor, int minSize) {
+    return Visitor::boundsSize ? std::max(minSize, visitor.sizeFloor()) : minSize;
+}
+
+// The clique R under construction: its members when they are needed,
+// otherwise only its size.
+template <bool keepMembers>
+class CliqueTrail {
+public:
+    CliqueTrail() {}
+    CliqueTrail(const int* first, const int* last) : members(first, last) {}
+
+    void push(int v) { members.push_back(v); }
+    void pop() { members.pop_back(); }
+    int size() const { return static_cast<int>(members.size()); }
+    const int* data() const { return members.data(); }
+
+    // Reports a clique the loaded kernel completed on top of this one.
+    template <class Visitor>
+    void visitWithKernel(const LocalBitGraph& kernel, int size, Visitor& visitor) {
+        size_t base = members.size();
+        kernel.appendClique(members);
+        visitor.visit(members.data(), size);
+        members.resize(base);
+    }
+
+private:
+    std::vector<int> members;
+};
+
+template <>
+class CliqueTrail<false> {
+public:
+    CliqueTrail() : depth(0) {}
+    CliqueTrail(const int* first, const int* last) : depth(static_cast<int>(last - first)) {}
+
+    void push(int) { depth++; }
+    void pop() { depth--; }
+    int size() const { return depth; }
+    const int* data() const { return nullptr; }
+
+    template <class Visitor>
+    void visitWithKernel(const LocalBitGraph&, int size, Visitor& visitor) { visitor.visit(nullptr, size); }
+
+private:
+    int depth;
+};
+
+// Enumerates the subproblem loaded into kernel, extending the clique in
+// trail, and hands every maximal clique of at least minSize vertices to
+// visitor.
+template <class Visitor>
+void enumerateInKernel(LocalBitGraph& kernel, CliqueTrail<Visitor::needsMembers>& trail, Visitor& visitor, int minSize = 0) {
+    kernel.enumerate<Visitor::needsMembers>(trail.size(), [&](int size) {
+        trail.visitWithKernel(kernel, size, visitor);
+    }, [&]() { return searchFloor(visitor, minSize); });
+}
+
+#endif
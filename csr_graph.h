@@ -0,0 +1,228 @@
+#ifndef CSR_GRAPH_H
+#define CSR_GRAPH_H
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+
+#include "parallel.h"
+
+// Read-only view over one vertex's neighbor array.
+struct NeighborRange {
+    const int* first;
+    const int* last;
+
+    const int* begin() const { return first; }
+    const int* end() const { return last; }
+    int size() const { return static_cast<int>(last - first); }
+    bool empty() const { return first == last; }
+    int operator[](int i) const { return first[i]; }
+};
+
+// Undirected graph in compressed sparse row form. The neighbors of v are
+// targets[offsets[v] .. offsets[v + 1]), sorted ascending and free of
+// duplicates and self-loops. The two arrays are either owned by the graph,
+// borrowed from storage it keeps alive, such as a mapped snapshot file, or
+// borrowed from buffers the caller keeps in place.
+class CSRGraph {
+public:
+    CSRGraph() : numVertices(0), targetCount(0), offsetArray(emptyOffsets()), targetArray(nullptr) {}
+
+    CSRGraph(const CSRGraph& other)
+        : numVertices(other.numVertices), targetCount(other.targetCount),
+          offsets(other.offsets), targets(other.targets), storage(other.storage),
+          offsetArray(other.offsetArray), targetArray(other.targetArray) {
+        if (other.ownsArrays()) bindOwnedArrays();
+    }
+
+    // Moving a vector keeps its buffer, so borrowed pointers stay valid.
+    CSRGraph(CSRGraph&& other) noexcept = default;
+    CSRGraph& operator=(CSRGraph&& other) noexcept = default;
+
+    CSRGraph& operator=(const CSRGraph& other) {
+        if (this != &other) {
+            CSRGraph copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    // Wraps arrays that live in external storage; the graph holds a reference
+    // to that storage for as long as it exists.
+    static CSRGraph fromExternalArrays(int n, const int64_t* offsets, const int* targets,
+                                       std::shared_ptr<const void> storage) {
+        CSRGraph g;
+        g.numVertices = n;
+        g.targetCount = offsets[n];
+        g.storage = std::move(storage);
+        g.offsetArray = offsets;
+        g.targetArray = targets;
+        return g;
+    }
+
+    // A view of arrays the caller owns, which must stay in place, unchanged,
+    // for as long as the graph or any copy of it is used.
+    static CSRGraph fromBorrowedArrays(int n, const int64_t* offsets, const int* targets) {
+        return fromExternalArrays(n, offsets, targets, nullptr);
+    }
+
+    int vertexCount() const { return numVertices; }
+    int64_t directedEdgeCount() const { return targetCount; }
+    int64_t edgeCount() const { return directedEdgeCount() / 2; }
+
+    int degree(int v) const { return static_cast<int>(offsetArray[v + 1] - offsetArray[v]); }
+
+    NeighborRange neighbors(int v) const {
+        return NeighborRange{targetArray + offsetArray[v], targetArray + offsetArray[v + 1]};
+    }
+
+    // The neighbors of v below and above v itself. With vertices numbered in
+    // search order these are the ones before and after it; a sorted neighbor
+    // array already holds them as two contiguous halves.
+    NeighborRange earlierNeighbors(int v) const {
+        NeighborRange all = neighbors(v);
+        return NeighborRange{all.first, std::lower_bound(all.first, all.last, v)};
+    }
+
+    NeighborRange laterNeighbors(int v) const {
+        NeighborRange all = neighbors(v);
+        return NeighborRange{std::upper_bound(all.first, all.last, v), all.last};
+    }
+
+    // Raw arrays, for serialization.
+    const int64_t* offsetData() const { return offsetArray; }
+    const int* targetData() const { return targetArray; }
+
+    typedef std::vector<std::pair<int, int>> EdgeBlock;
+
+    // Builds the graph from an undirected edge list split across several
+    // buffers, typically one per parsing thread. Each pair may appear in
+    // either or both directions and any number of times; self-loops and pairs
+    // with an endpoint outside [0, n) are dropped. The buffers are consumed.
+    // Degree counting, scattering and the per-vertex sort/dedupe all run on
+    // the given number of threads.
+    static CSRGraph fromEdgeBlocks(int n, std::vector<EdgeBlock>& blocks, int threads) {
+        CSRGraph g;
+        g.numVertices = n;
+        g.offsets.assign(static_cast<size_t>(n) + 1, 0);
+        int blockCount = static_cast<int>(blocks.size());
+
+        // Counters are only updated atomically when several threads share them.
+        bool shared = threads > 1 && blockCount > 1;
+        std::vector<int64_t> cursor(static_cast<size_t>(n) + 1, 0);
+        parallelForDynamic(0, blockCount, 1, threads, [&](int64_t lo, int64_t hi, int) {
+            for (int64_t b = lo; b < hi; b++) {
+                for (const auto& e : blocks[b]) {
+                    if (!validEdge(e, n)) continue;
+                    bump(cursor[e.first], shared);
+                    bump(cursor[e.second], shared);
+                }
+            }
+        });
+
+        parallelFor(0, n, threads, [&](int64_t lo, int64_t hi, int) {
+            for (int64_t v = lo; v < hi; v++) g.offsets[v] = cursor[v];
+        });
+        int64_t total = parallelExclusiveScan(g.offsets.data(), n, threads);
+        g.offsets[n] = total;
+        parallelFor(0, n, threads, [&](int64_t lo, int64_t hi, int) {
+            for (int64_t v = lo; v < hi; v++) cursor[v] = g.offsets[v];
+        });
+
+        std::vector<int> scattered(total);
+        parallelForDynamic(0, blockCount, 1, threads, [&](int64_t lo, int64_t hi, int) {
+            for (int64_t b = lo; b < hi; b++) {
+                for (const auto& e : blocks[b]) {
+                    if (!validEdge(e, n)) continue;
+                    scattered[bump(cursor[e.first], shared)] = e.second;
+                    scattered[bump(cursor[e.second], shared)] = e.first;
+                }
+                EdgeBlock().swap(blocks[b]);
+            }
+        });
+        std::vector<int64_t>().swap(cursor);
+
+        // Sort and dedupe each neighbor array in place, then pack the
+        // surviving entries into the final targets array.
+        std::vector<int64_t> kept(n, 0);
+        parallelForDynamic(0, n, 1024, threads, [&](int64_t lo, int64_t hi, int) {
+            for (int64_t v = lo; v < hi; v++) {
+                int* first = scattered.data() + g.offsets[v];
+                int* last = scattered.data() + g.offsets[v + 1];
+                std::sort(first, last);
+                kept[v] = std::unique(first, last) - first;
+            }
+        });
+
+        std::vector<int64_t> packed(kept);
+        int64_t packedTotal = parallelExclusiveScan(packed.data(), n, threads);
+        g.targets.resize(packedTotal);
+        parallelForDynamic(0, n, 1024, threads, [&](int64_t lo, int64_t hi, int) {
+            for (int64_t v = lo; v < hi; v++) {
+                std::copy(scattered.begin() + g.offsets[v], scattered.begin() + g.offsets[v] + kept[v],
+                          g.targets.begin() + packed[v]);
+            }
+        });
+        std::copy(packed.begin(), packed.end(), g.offsets.begin());
+        g.offsets[n] = packedTotal;
+        g.targetCount = packedTotal;
+        g.bindOwnedArrays();
+        return g;
+    }
+
+    // Copy of the graph with vertex v renamed newId[v], where newId is a
+    // permutation of [0, n). Neighbor arrays are re-sorted under the new IDs.
+    CSRGraph relabeled(const std::vector<int>& newId, int threads = 1) const {
+        int n = numVertices;
+        CSRGraph g;
+        g.numVertices = n;
+        g.targetCount = targetCount;
+        g.offsets.assign(static_cast<size_t>(n) + 1, 0);
+        for (int v = 0; v < n; v++) g.offsets[newId[v] + 1] = degree(v);
+        for (int v = 0; v < n; v++) g.offsets[v + 1] += g.offsets[v];
+        g.targets.resize(targetCount);
+        parallelForDynamic(0, n, 1024, threads, [&](int64_t lo, int64_t hi, int) {
+            for (int64_t v = lo; v < hi; v++) {
+                int* out = g.targets.data() + g.offsets[newId[v]];
+                int* last = out;
+                for (int w : neighbors(static_cast<int>(v))) *last++ = newId[w];
+                std::sort(out, last);
+            }
+        });
+        g.bindOwnedArrays();
+        return g;
+    }
+
+private:
+    static const int64_t* emptyOffsets() {
+        static const int64_t zero = 0;
+        return &zero;
+    }
+
+    bool ownsArrays() const { return offsetArray == (offsets.empty() ? emptyOffsets() : offsets.data()); }
+
+    void bindOwnedArrays() {
+        offsetArray = offsets.empty() ? emptyOffsets() : offsets.data();
+        targetArray = targets.data();
+    }
+
+    static int64_t bump(int64_t& counter, bool shared) {
+        return shared ? __atomic_fetch_add(&counter, 1, __ATOMIC_RELAXED) : counter++;
+    }
+
+    static bool validEdge(const std::pair<int, int>& e, int n) {
+        return e.first != e.second && e.first >= 0 && e.second >= 0 && e.first < n && e.second < n;
+    }
+
+    int numVertices;
+    int64_t targetCount;
+    std::vector<int64_t> offsets;
+    std::vector<int> targets;
+    std::shared_ptr<const void> storage;
+    const int64_t* offsetArray;
+    const int* targetArray;
+};
+
+#endif
@@ -0,0 +1,164 @@
+#ifndef DEGENERACY_H
+#define DEGENERACY_H
+
+#include <vector>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+
+#include "csr_graph.h"
+#include "parallel.h"
+#include "profiling.h"
+
+// The result of peeling a graph down to nothing, minimum degree first.
+struct CoreDecomposition {
+    // Vertices in removal order. Each has at most degeneracy neighbors later
+    // in it, so it serves as the degeneracy ordering of the searches.
+    std::vector<int> order;
+    // Core number of every vertex: the largest k such that the vertex lies
+    // in the k-core, the maximal subgraph of minimum degree k.
+    std::vector<int> coreNumber;
+    int degeneracy = 0;
+};
+
+// Batagelj-Zaversnik bucket peel in O(n + m) time and O(n) memory: vertices
+// sit in one array sorted by remaining degree, and removing the front vertex
+// moves each neighbor of higher degree to the front of its bucket and
+// shrinks that bucket by one, so no vertex is ever stored twice.
+inline CoreDecomposition peelCoresSerial(const CSRGraph& graph) {
+    int n = graph.vertexCount();
+    CoreDecomposition result;
+    std::vector<int>& degree = result.coreNumber;
+    degree.resize(n);
+    int maxDegree = 0;
+    for (int v = 0; v < n; v++) {
+        degree[v] = graph.degree(v);
+        maxDegree = std::max(maxDegree, degree[v]);
+    }
+
+    std::vector<int> bucketStart(maxDegree + 2, 0);
+    for (int v = 0; v < n; v++) bucketStart[degree[v] + 1]++;
+    for (int d = 0; d <= maxDegree; d++) bucketStart[d + 1] += bucketStart[d];
+    std::vector<int>& vertexAt = result.order;
+    vertexAt.resize(n);
+    std::vector<int> slot(n);
+    std::vector<int> fill(bucketStart.begin(), bucketStart.end() - 1);
+    for (int v = 0; v < n; v++) {
+        slot[v] = fill[degree[v]]++;
+        vertexAt[slot[v]] = v;
+    }
+
+    // degree[v] is frozen once v reaches the front; that value is its core
+    for (int i = 0; i < n; i++) {
+        int v = vertexAt[i];
+        result.degeneracy = std::max(result.degeneracy, degree[v]);
+        for (int w : graph.neighbors(v)) {
+            int d = degree[w];
+            if (d <= degree[v]) continue;
+            int first = bucketStart[d];
+            int u = vertexAt[first];
+            std::swap(vertexAt[first], vertexAt[slot[w]]);
+            slot[u] = slot[w];
+            slot[w] = first;
+            bucketStart[d] = first + 1;
+            degree[w] = d - 1;
+        }
+    }
+    return result;
+}
+
+// Level-synchronous peel: at level k, every remaining vertex of degree at
+// most k is removed at once, in parallel, and neighbors whose degree falls
+// to k form the next round of the same level. When a level runs dry, one
+// scan of the remaining vertices finds the next nonempty level and drops
+// the removed ones from the list. A vertex removed at level k had at most k
+// neighbors left, so the removal order is still a degeneracy ordering, and
+// k is its core number. Degrees are decremented atomically; exactly one
+// thread sees a neighbor cross from k + 1 to k and queues it.
+inline CoreDecomposition peelCoresParallel(const CSRGraph& graph, int threads) {
+    // Rounds smaller than this run on the calling thread
+    const int64_t PARALLEL_ROUND = 4096;
+
+    int n = graph.vertexCount();
+    threads = std::max(1, threads);
+    CoreDecomposition result;
+    result.order.reserve(n);
+    std::vector<int>& core = result.coreNumber;
+    core.assign(n, -1);
+    std::vector<int> degree(n);
+    parallelFor(0, n, threads, [&](int64_t lo, int64_t hi, int) {
+        for (int64_t v = lo; v < hi; v++) degree[v] = graph.degree(static_cast<int>(v));
+    });
+
+    std::vector<int> remaining(n);
+    for (int v = 0; v < n; v++) remaining[v] = v;
+    std::vector<int> frontier;
+    std::vector<std::vector<int>> found(threads);
+    int k = 0;
+
+    while (static_cast<int>(result.order.size()) < n) {
+        if (frontier.empty()) {
+            // Next level: the smallest degree left, and every vertex at it
+            int blocks = static_cast<int64_t>(remaining.size()) >= PARALLEL_ROUND ? threads : 1;
+            std::vector<int> blockMinimum(blocks, INT_MAX);
+            std::vector<std::vector<int>> kept(blocks);
+            parallelFor(0, blocks, blocks, [&](int64_t, int64_t, int b) {
+                size_t lo = remaining.size() * b / blocks;
+                size_t hi = remaining.size() * (b + 1) / blocks;
+                for (size_t i = lo; i < hi; i++) {
+                    int v = remaining[i];
+                    if (core[v] >= 0) continue;
+                    kept[b].push_back(v);
+                    blockMinimum[b] = std::min(blockMinimum[b], degree[v]);
+                }
+            });
+            remaining.clear();
+            for (int b = 0; b < blocks; b++) remaining.insert(remaining.end(), kept[b].begin(), kept[b].end());
+            k = std::max(k, *std::min_element(blockMinimum.begin(), blockMinimum.end()));
+            for (int v : remaining) {
+                if (degree[v] <= k) frontier.push_back(v);
+            }
+            result.degeneracy = k;
+        }
+
+        // Claim the whole round before touching any degree, so that
+        // vertices removed together do not decrement each other
+        for (int v : frontier) core[v] = k;
+        result.order.insert(result.order.end(), frontier.begin(), frontier.end());
+
+        int workers = static_cast<int64_t>(frontier.size()) >= PARALLEL_ROUND ? threads : 1;
+        parallelForDynamic(0, frontier.size(), 256, workers, [&](int64_t lo, int64_t hi, int thread) {
+            for (int64_t i = lo; i < hi; i++) {
+                for (int w : graph.neighbors(frontier[i])) {
+                    if (core[w] >= 0) continue;
+                    int before = __atomic_fetch_sub(&degree[w], 1, __ATOMIC_RELAXED);
+                    if (before == k + 1) found[thread].push_back(w);
+                }
+            }
+        });
+        frontier.clear();
+        for (auto& list : found) {
+            frontier.insert(frontier.end(), list.begin(), list.end());
+            list.clear();
+        }
+    }
+    return result;
+}
+
+// Graphs with at least this many neighbor entries are peeled in parallel
+// when more than one thread is given.
+const int64_t PARALLEL_PEEL_MIN_ENTRIES = int64_t(1) << 22;
+
+inline CoreDecomposition decomposeCores(const CSRGraph& graph, int threads = 1) {
+    PROFILE_PHASE(ORDERING);
+    if (threads > 1 && graph.directedEdgeCount() >= PARALLEL_PEEL_MIN_ENTRIES) {
+        return peelCoresParallel(graph, threads);
+    }
+    return peelCoresSerial(graph);
+}
+
+inline std::vector<int> computeCoreNumbers(const CSRGraph& graph, int threads = 1) {
+    return decomposeCores(graph, threads).coreNumber;
+}
+
+#endif
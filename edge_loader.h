@@ -0,0 +1,178 @@
+#ifndef EDGE_LOADER_H
+#define EDGE_LOADER_H
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <cstring>
+#include <climits>
+
+#include "mapped_file.h"
+#include "parallel.h"
+
+// Raw contents of an edge-list file: the declared counts, if any, and every
+// "u v" pair. Edges are kept in the per-thread blocks they were parsed into,
+// in file order across blocks.
+struct EdgeListData {
+    bool headerFound = false;
+    int64_t declaredNodes = 0;
+    int64_t declaredEdges = 0;
+    int64_t edgeLines = 0;
+    int minVertexId = INT_MAX;
+    int maxVertexId = -1;
+    std::vector<std::vector<std::pair<int, int>>> edgeBlocks;
+};
+
+namespace edgescan {
+
+inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+inline const char* nextLine(const char* p, const char* end) {
+    const void* nl = memchr(p, '\n', end - p);
+    return nl ? static_cast<const char*>(nl) + 1 : end;
+}
+
+// Parses an optionally signed decimal integer at p, skipping leading blanks.
+// Leaves p just past the digits; returns false if there are none.
+inline bool parseInteger(const char*& p, const char* end, int64_t& value) {
+    while (p < end && isBlank(*p)) p++;
+    bool negative = false;
+    if (p < end && *p == '-') {
+        negative = true;
+        p++;
+    }
+    if (p >= end || !isDigit(*p)) return false;
+    int64_t result = 0;
+    while (p < end && isDigit(*p)) {
+        if (result < (INT64_MAX - 9) / 10) result = result * 10 + (*p - '0');
+        p++;
+    }
+    value = negative ? -result : result;
+    return true;
+}
+
+// Reads the number following the label in [p, end), e.g. "Nodes:".
+inline bool parseLabeledCount(const char* p, const char* end, const char* label, int64_t& value) {
+    size_t labelLength = strlen(label);
+    for (const char* q = p; q + labelLength <= end; q++) {
+        if (memcmp(q, label, labelLength) == 0) {
+            const char* digits = q + labelLength;
+            return parseInteger(digits, end, value);
+        }
+    }
+    return false;
+}
+
+// Parses one "u v" data line into an edge. Returns false for anything that
+// is not a pair of integers, such as a "FromNodeId ToNodeId" column header.
+inline bool parseEdgeLine(const char* p, const char* end, int64_t& u, int64_t& v) {
+    return parseInteger(p, end, u) && parseInteger(p, end, v);
+}
+
+struct ChunkResult {
+    int64_t edgeLines = 0;
+    int minVertexId = INT_MAX;
+    int maxVertexId = -1;
+};
+
+// Appends every edge line in [p, end) to block. Comments and other
+// non-numeric lines are skipped.
+inline void parseChunk(const char* p, const char* end, std::vector<std::pair<int, int>>& block, ChunkResult& result) {
+    while (p < end) {
+        const char* lineEnd = nextLine(p, end);
+        int64_t u, v;
+        if (parseEdgeLine(p, lineEnd, u, v) &&
+            u >= INT_MIN && u <= INT_MAX && v >= INT_MIN && v <= INT_MAX) {
+            int a = static_cast<int>(u);
+            int b = static_cast<int>(v);
+            block.push_back({a, b});
+            result.minVertexId = std::min(result.minVertexId, std::min(a, b));
+            result.maxVertexId = std::max(result.maxVertexId, std::max(a, b));
+            result.edgeLines++;
+        }
+        p = lineEnd;
+    }
+}
+
+}
+
+// Loads a SNAP-style edge list from a memory-mapped file. A "# Nodes: N
+// Edges: M" comment ahead of the first data line supplies the declared
+// counts; without one, and if allowCountLine is set, a first data line of the
+// form "N M" is taken as the counts instead. Other comments, blank lines and
+// non-numeric lines are skipped. The body after the header is cut into
+// newline-aligned chunks that are parsed concurrently, one edge block per
+// chunk. Returns false only if the file cannot be opened.
+inline bool loadEdgeList(const std::string& path, EdgeListData& out, bool allowCountLine, int threads = hardwareThreads()) {
+    MappedFile file;
+    if (!file.open(path)) return false;
+
+    out = EdgeListData();
+    const char* p = file.data();
+    const char* end = p + file.size();
+
+    // Header scan: stops at the first data line, or just past a count line.
+    while (p < end) {
+        const char* lineEnd = edgescan::nextLine(p, end);
+        const char* q = p;
+        while (q < lineEnd && edgescan::isBlank(*q)) q++;
+
+        if (q < lineEnd && *q == '#') {
+            int64_t nodes, edges;
+            if (!out.headerFound &&
+                edgescan::parseLabeledCount(q, lineEnd, "Nodes:", nodes) &&
+                edgescan::parseLabeledCount(q, lineEnd, "Edges:", edges)) {
+                out.headerFound = true;
+                out.declaredNodes = nodes;
+                out.declaredEdges = edges;
+            }
+            p = lineEnd;
+            continue;
+        }
+
+        int64_t u, v;
+        if (edgescan::parseEdgeLine(q, lineEnd, u, v)) {
+            if (!out.headerFound && allowCountLine) {
+                out.headerFound = true;
+                out.declaredNodes = u;
+                out.declaredEdges = v;
+                p = lineEnd;
+            }
+            break;
+        }
+        p = lineEnd;
+    }
+
+    // Every edge line takes at least four bytes, which bounds a bogus header.
+    size_t bodyBytes = static_cast<size_t>(end - p);
+    int64_t expectedEdges = out.declaredEdges > 0 ? std::min<int64_t>(out.declaredEdges, bodyBytes / 4)
+                                                  : static_cast<int64_t>(bodyBytes / 8);
+    const size_t minChunkBytes = 1 << 20;
+    int chunks = static_cast<int>(std::max<size_t>(1, std::min<size_t>(std::max(threads, 1), bodyBytes / minChunkBytes)));
+
+    std::vector<const char*> cuts(chunks + 1, end);
+    cuts[0] = p;
+    for (int c = 1; c < chunks; c++) {
+        const char* approx = p + bodyBytes * c / chunks;
+        cuts[c] = std::max(cuts[c - 1], edgescan::nextLine(approx, end));
+    }
+
+    out.edgeBlocks.resize(chunks);
+    std::vector<edgescan::ChunkResult> results(chunks);
+    parallelFor(0, chunks, chunks, [&](int64_t, int64_t, int c) {
+        out.edgeBlocks[c].reserve(static_cast<size_t>(expectedEdges / chunks + 1));
+        edgescan::parseChunk(cuts[c], cuts[c + 1], out.edgeBlocks[c], results[c]);
+    });
+
+    for (const auto& result : results) {
+        out.edgeLines += result.edgeLines;
+        out.minVertexId = std::min(out.minVertexId, result.minVertexId);
+        out.maxVertexId = std::max(out.maxVertexId, result.maxVertexId);
+    }
+    return true;
+}
+
+#endif
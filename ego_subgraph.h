@@ -0,0 +1,97 @@
+#ifndef EGO_SUBGRAPH_H
+#define EGO_SUBGRAPH_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "csr_graph.h"
+
+// The part of the graph one subproblem (P, X) can still reach: the
+// candidates P and the excluded vertices that touch P, copied out under
+// local IDs 0..k-1 with every adjacency trimmed to those k vertices. A
+// search run on the copy walks short contiguous lists instead of full
+// neighborhoods scattered over the whole graph. The vertices already in the
+// clique are adjacent to all of them and are not stored. One instance is
+// reused per worker: its buffers only grow, so once they reach the largest
+// subproblem's size a build allocates nothing.
+class EgoSubgraph {
+public:
+    EgoSubgraph() {}
+
+    // graph() views this instance's own buffers, which a move carries along
+    // and a copy would not.
+    EgoSubgraph(const EgoSubgraph&) = delete;
+    EgoSubgraph& operator=(const EgoSubgraph&) = delete;
+    EgoSubgraph(EgoSubgraph&&) = default;
+    EgoSubgraph& operator=(EgoSubgraph&&) = default;
+
+    // Copies the subproblem (P, X) of graph. P must not be empty: an excluded
+    // vertex with no neighbor in P can never block a clique below this level,
+    // so only those adjacent to some candidate are kept. Local IDs follow the
+    // graph IDs, so each trimmed adjacency comes out sorted.
+    void build(const CSRGraph& graph, const int* P, int pCount, const int* X, int xCount) {
+        if (static_cast<int>(localIndex.size()) < graph.vertexCount()) {
+            localIndex.assign(graph.vertexCount(), UNMAPPED);
+        }
+        for (int i = 0; i < xCount; i++) localIndex[X[i]] = EXCLUDED;
+        for (int i = 0; i < pCount; i++) localIndex[P[i]] = CANDIDATE;
+
+        vertices.assign(P, P + pCount);
+        for (int i = 0; i < pCount; i++) {
+            for (int w : graph.neighbors(P[i])) {
+                if (localIndex[w] == EXCLUDED) {
+                    localIndex[w] = KEPT_EXCLUDED;
+                    vertices.push_back(w);
+                }
+            }
+        }
+        std::sort(vertices.begin(), vertices.end());
+
+        int k = static_cast<int>(vertices.size());
+        localCandidates.clear();
+        localExcluded.clear();
+        for (int i = 0; i < k; i++) {
+            int& slot = localIndex[vertices[i]];
+            (slot == CANDIDATE ? localCandidates : localExcluded).push_back(i);
+            slot = i;
+        }
+
+        offsets.clear();
+        targets.clear();
+        offsets.push_back(0);
+        for (int i = 0; i < k; i++) {
+            for (int w : graph.neighbors(vertices[i])) {
+                if (localIndex[w] >= 0) targets.push_back(localIndex[w]);
+            }
+            offsets.push_back(targets.size());
+        }
+        local = CSRGraph::fromBorrowedArrays(k, offsets.data(), targets.data());
+
+        for (int i = 0; i < pCount; i++) localIndex[P[i]] = UNMAPPED;
+        for (int i = 0; i < xCount; i++) localIndex[X[i]] = UNMAPPED;
+    }
+
+    const CSRGraph& graph() const { return local; }
+
+    // Local IDs of P and of the excluded vertices kept, ascending.
+    const std::vector<int>& candidates() const { return localCandidates; }
+    const std::vector<int>& excluded() const { return localExcluded; }
+
+    // Graph ID of every local vertex.
+    const int* graphIds() const { return vertices.data(); }
+    int graphId(int v) const { return vertices[v]; }
+
+private:
+    enum { UNMAPPED = -1, EXCLUDED = -2, KEPT_EXCLUDED = -3, CANDIDATE = -4 };
+
+    CSRGraph local;               // view of offsets and targets
+    std::vector<int64_t> offsets;
+    std::vector<int> targets;
+    std::vector<int> localIndex;  // graph vertex -> local ID while building
+    std::vector<int> vertices;    // local ID -> graph vertex
+    std::vector<int> localCandidates;
+    std::vector<int> localExcluded;
+};
+
+#endif
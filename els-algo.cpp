@@ -3,158 +3,266 @@
 #include <set>
 #include <unordered_set>
 #include <algorithm>
-#include <fstream>
-#include <sstream>
 #include <string>
 #include <chrono>
 #include <queue>
 #include <map>
 #include <climits>
-#include <unordered_map>
+
+#include "csr_graph.h"
+#include "edge_loader.h"
+#include "graph_snapshot.h"
+#include "run_options.h"
+#include "work_stealing.h"
+#include "clique_stats.h"
+#include "bitset_kernel.h"
+#include "kernel_select.h"
+#include "pivot_rule.h"
+#include "ego_subgraph.h"
+#include "set_ops.h"
+#include "clique_sink.h"
+#include "clique_visitor.h"
+#include "max_clique.h"
+#include "degeneracy.h"
+#include "profiling.h"
 
 using namespace std;
 using namespace std::chrono;
 
 class GraphCliqueAnalyzer {
 public:
-    GraphCliqueAnalyzer() : nodeCount(0), largestCliqueSize(0), totalCliques(0) {}
-   
-    void buildGraphFromFile(const string& dataFile) {
-        ifstream inputStream(dataFile);
-        if (!inputStream) {
-            cerr << "Error opening file: " << dataFile << endl;
-            return;
-        }
+    GraphCliqueAnalyzer() : nodeCount(0), loaderThreads(1), searchWorkers(1), minCliqueSize(1), relabelNodes(false), pivotRule(PIVOT_TOMITA), relabeled(false), splitPool(nullptr) {}
 
-        string textLine;
-        int linkCount = 0;
-        bool headerDetected = false;
-        idMapper.clear();
+    // Threads used for parsing/building and for the clique search
+    void configureThreads(int loading, int searching) {
+        loaderThreads = max(1, loading);
+        searchWorkers = max(1, searching);
+    }
 
-        // Look for header with node and edge count
-        while (getline(inputStream, textLine)) {
-    // Skip empty lines
-    if (textLine.empty()) {
-        continue;
+    // Cliques with fewer nodes than this are not searched for or reported
+    void setMinimumCliqueSize(int size) {
+        minCliqueSize = max(1, size);
     }
-   
-    // Check if line is a comment
-    if (textLine[0] == '#') {
-        // Look for the specific header format in the comment
-        size_t nodesPos = textLine.find("Nodes:");
-        size_t edgesPos = textLine.find("Edges:");
-       
-        if (nodesPos != string::npos && edgesPos != string::npos) {
-            // Extract the numbers using substring operations instead of stringstream
-            string nodeStr = textLine.substr(nodesPos + 6);  // "Nodes:" is 6 characters
-            string edgeStr = textLine.substr(edgesPos + 6);  // "Edges:" is 6 characters
-           
-            // Convert strings to integers
-            nodeCount = stoi(nodeStr);
-            linkCount = stoi(edgeStr);
-            headerDetected = true;
-        }
-        continue;
+
+    // Renumber nodes by their position in the search order before searching
+    void setRelabel(bool enabled) {
+        relabelNodes = enabled;
+    }
+
+    // Pivot rule of every search frame, in the recursion and the kernel
+    void setPivotRule(PivotRule rule) {
+        pivotRule = rule;
     }
    
-    // If we reach here, we've found a non-comment, non-empty line
-    // Exit the loop as per original code
-    break;
-}
-// Attempt to read header using primary format
-if (!headerDetected) {
-    // Reset stream position to beginning
-    inputStream.clear();
-    inputStream.seekg(0, std::ios::beg);
-   
-    // Try to extract node count and link count directly
-    std::string line;
-    if (std::getline(inputStream, line)) {
-        std::istringstream lineStream(line);
-        if (lineStream >> nodeCount >> linkCount) {
-            headerDetected = true;
+    bool buildGraphFromFile(const string& dataFile) {
+        PROFILE_PHASE(LOAD);
+        storedOrder.clear();
+        coreNumbers.clear();
+        relabeled = false;
+
+        // Snapshots already hold the relabeled, deduplicated graph
+        if (isGraphSnapshot(dataFile)) {
+            return restoreSnapshot(dataFile);
         }
-    }
-}
 
+        // Parse the whole file in one pass over a memory mapping
+        EdgeListData fileData;
+        if (!loadEdgeList(dataFile, fileData, true, loaderThreads)) {
+            cerr << "Error opening file: " << dataFile << endl;
+            return false;
+        }
 
-// Validate node count
-if (nodeCount <= 0) {
-    std::cerr << "Error: Node count must be positive, found: " << nodeCount << std::endl;
-    return;
-}
+        // Check if header detection was successful
+        if (!fileData.headerFound) {
+            cerr << "Error: Failed to detect header containing node and edge counts" << endl;
+            return false;
+        }
 
-// Check if header detection was successful
-if (!headerDetected) {
-    std::cerr << "Error: Failed to detect header containing node and edge counts" << std::endl;
-    return;
-}
+        // Validate node count
+        if (fileData.declaredNodes <= 0 || fileData.declaredNodes > INT_MAX) {
+            cerr << "Error: Node count must be positive, found: " << fileData.declaredNodes << endl;
+            return false;
+        }
+        nodeCount = static_cast<int>(fileData.declaredNodes);
 
+        // Map every endpoint to an internal ID in place
+        int workerCount = loaderThreads;
+        int distinctNodes = assignInternalIds(fileData, workerCount);
+        nodeCount = max(nodeCount, distinctNodes);
 
+        // Build the compressed adjacency from the per-thread edge blocks
+        graph = CSRGraph::fromEdgeBlocks(nodeCount, fileData.edgeBlocks, workerCount);
+        nodeCount = graph.vertexCount();
+        cout << "Loaded graph with " << nodeCount << " nodes and " << fileData.edgeLines << " edges." << endl;
+        return true;
+    }
 
-        // Initialize graph
-        connections.clear();
-        connections.resize(nodeCount);
+    // Write the loaded graph, its node order and the original IDs to a snapshot
+    bool storeSnapshot(const string& snapshotFile) {
+        if (storedOrder.empty()) {
+            storedOrder = calculateOptimalOrder();
+        }
 
-        // Read all connections
-        inputStream.clear();
-        inputStream.seekg(0, ios::beg);
-       
-        int actualLinkCount = 0;
-        bool skipFirstLine = true;
-       
-   while (std::getline(inputStream, textLine)) {
-    // Ignore empty lines, comments, and metadata lines
-    if (textLine.empty() || textLine[0] == '#') {
-        continue;
-    }
-   
-    // Skip lines containing header information
-    if (textLine.find("Nodes:") != std::string::npos ||
-        textLine.find("Edges:") != std::string::npos ||
-        textLine.find("FromNodeId") != std::string::npos) {
-        continue;
+        // The ID table has to cover every node for the snapshot to keep it
+        assignOutputIds();
+        string error;
+        if (!saveGraphSnapshot(snapshotFile, graph, &storedOrder, &outputIds, error)) {
+            cerr << "Error: Failed to save snapshot: " << error << endl;
+            return false;
+        }
+        cout << "Saved graph snapshot to " << snapshotFile << endl;
+        return true;
     }
    
-    // Check if this is potentially a header line with node/edge counts
-    if (skipFirstLine) {
-        std::istringstream headerCheck(textLine);
-        int nodeCountCheck, edgeCountCheck;
+    // Every maximal clique is also written to output when one is given; it
+    // needs a buffer for each search worker
+    void analyzeGraph(CliqueSink* output = nullptr) {
+        auto startMoment = high_resolution_clock::now();
+       
+        // Get optimal ordering
+        vector<int> nodeOrder = searchOrder();
+       
+        // Search with one visitor per worker; only an output needs the
+        // clique members, otherwise the search just tracks clique sizes
+        cliqueTotals.clear();
+        if (output) {
+            assignOutputIds();
+            output->setIdMap(&outputIds);
+            vector<CliqueSinkVisitor> visitors;
+            int worker = 0;
+            while (worker < searchWorkers) {
+                visitors.emplace_back(output, worker);
+                worker++;
+            }
+            searchFromEachNode(nodeOrder, visitors);
+        } else {
+            vector<CliqueHistogramVisitor> visitors(searchWorkers);
+            searchFromEachNode(nodeOrder, visitors);
+        }
+       
+        auto endMoment = high_resolution_clock::now();
+        auto timeElapsed = duration_cast<microseconds>(endMoment - startMoment);
+       
+        // Print results
+        cout << "1. Largest Clique Size: " << cliqueTotals.largestCliqueSize << endl;
+        cout << "2. Total Number of Maximal Cliques: " << cliqueTotals.totalCliques << endl;
+        cout << "3. Execution Time: " << timeElapsed.count() / 1000.0 << " ms" << endl;
+        cout << "4. Distribution of Clique Sizes:" << endl;
        
-        // If line contains node count that matches expected, skip it
-        if (headerCheck >> nodeCountCheck >> edgeCountCheck &&
-            nodeCountCheck == nodeCount) {
-            skipFirstLine = false;
-            continue;
+        int size = 1;
+        while (size <= cliqueTotals.largestCliqueSize) {
+            cout << "   - Cliques of size " << size << ": " << cliqueTotals.count(size) << endl;
+            size++;
         }
        
-        // Not a header line, process normally but don't check again
-        skipFirstLine = false;
-    }
-   
-    // Process edge data
-    std::istringstream edgeParser(textLine);
-    int sourceNode, targetNode;
-   
-    if (edgeParser >> sourceNode >> targetNode) {
-        connectNodes(sourceNode, targetNode);
-        actualLinkCount++;
+        // Which engine the subproblems went to
+        KernelUsage usage;
+        int64_t searchNodes = 0;
+        for (const WorkerState& state : workerStates) {
+            usage.merge(state.bitKernel.usage());
+            searchNodes += state.bitKernel.searchNodes() + state.searchNodes;
+        }
+        cout << "5. Subproblem Engines: ";
+        printKernelUsage(cout, usage);
+        cout << "6. Search Tree Nodes: " << searchNodes << " (" << pivotRuleName(pivotRule) << " pivots)" << endl;
     }
-}
 
-        inputStream.close();
+    // Find one largest clique by branch and bound instead of enumerating;
+    // the clique also goes to output when one is given
+    void findLargestClique(CliqueSink* output = nullptr) {
+        auto startMoment = high_resolution_clock::now();
+       
+        vector<int> nodeOrder = searchOrder();
+        MaxCliqueSearch search(graph, nodeOrder, searchWorkers, &nodeCoreNumbers());
+        vector<int> largestClique = search.run();
+       
+        auto endMoment = high_resolution_clock::now();
+        auto timeElapsed = duration_cast<microseconds>(endMoment - startMoment);
        
-        // Update node count based on actual data
-        nodeCount = connections.size();
-        cout << "Loaded graph with " << nodeCount << " nodes and " << actualLinkCount << " edges." << endl;
+        // Report original IDs in ascending order
+        assignOutputIds();
+        if (output && !largestClique.empty()) {
+            output->setIdMap(&outputIds);
+            output->write(0, largestClique.data(), largestClique.size());
+        }
+        vector<int> members;
+        for (int node : largestClique) {
+            members.push_back(outputIds[node]);
+        }
+        sort(members.begin(), members.end());
+       
+        cout << "1. Largest Clique Size: " << members.size() << endl;
+        cout << "2. Maximum Clique:";
+        auto memberIter = members.begin();
+        while (memberIter != members.end()) {
+            cout << " " << *memberIter;
+            ++memberIter;
+        }
+        cout << endl;
+        cout << "3. Execution Time: " << timeElapsed.count() / 1000.0 << " ms" << endl;
     }
-   
-    void analyzeGraph() {
+
+    // Report the count largest maximal cliques; a shared bounded heap keeps
+    // them and its smallest size prunes the search
+    void findTopCliques(int count, CliqueSink* output = nullptr) {
         auto startMoment = high_resolution_clock::now();
        
-        // Get optimal ordering
-        vector<int> nodeOrder = calculateOptimalOrder();
+        vector<int> nodeOrder = searchOrder();
+        TopCliques top(count);
+        vector<TopCliqueVisitor> visitors(searchWorkers, TopCliqueVisitor(&top));
+        searchFromEachNode(nodeOrder, visitors);
+        vector<vector<int>> cliques = top.results();
+       
+        auto endMoment = high_resolution_clock::now();
+        auto timeElapsed = duration_cast<microseconds>(endMoment - startMoment);
        
+        // Report original IDs, each clique in ascending order
+        assignOutputIds();
+        if (output) {
+            output->setIdMap(&outputIds);
+        }
+        cout << "1. Largest Clique Size: " << (cliques.empty() ? 0 : cliques[0].size()) << endl;
+        cout << "2. Top " << cliques.size() << " Maximal Cliques:" << endl;
+        auto cliqueIter = cliques.begin();
+        while (cliqueIter != cliques.end()) {
+            if (output) {
+                output->write(0, cliqueIter->data(), cliqueIter->size());
+            }
+            vector<int> members;
+            for (int node : *cliqueIter) {
+                members.push_back(outputIds[node]);
+            }
+            sort(members.begin(), members.end());
+            cout << "   - Size " << members.size() << ":";
+            for (int member : members) {
+                cout << " " << member;
+            }
+            cout << endl;
+            ++cliqueIter;
+        }
+        cout << "3. Execution Time: " << timeElapsed.count() / 1000.0 << " ms" << endl;
+    }
+
+private:
+    // Per-worker search state
+    struct WorkerState {
+        vector<int> candidateNodes;
+        vector<int> excludedNodes;
+        LocalBitGraph bitKernel;
+        EgoSubgraph egoGraph;
+        PivotScores pivotScores; // Tomita counts over the ego subgraph
+        int64_t searchNodes = 0; // frames of the general recursion
+    };
+
+    // Index of the worker that owns a state
+    int currentWorker(const WorkerState& state) const {
+        return static_cast<int>(&state - workerStates.data());
+    }
+
+    // Run the search from every node of the order and add the visitors'
+    // counts to cliqueTotals
+    template <class Visitor>
+    void searchFromEachNode(const vector<int>& nodeOrder, vector<Visitor>& visitors) {
         // Create lookup for quick position finding
         vector<int> nodePositions(nodeCount);
        
@@ -164,270 +272,450 @@ if (!headerDetected) {
             idx++;
         }
        
-        // Working vectors
-        vector<int> cliqueMembers;
-        vector<int> candidateNodes;
-        vector<int> excludedNodes;
-        vector<int> tempList;
+        // Working vectors, one set per search worker
+        workerStates.clear();
+        workerStates.resize(searchWorkers);
+        for (WorkerState& state : workerStates) {
+            state.bitKernel.setPivotRule(pivotRule);
+        }
        
-        // Process each node in order
-        idx = 0;
-        while (idx < nodeCount) {
-            int currentNode = nodeOrder[idx];
+        // Cliques of at least floor nodes lie in the (floor - 1)-core, so
+        // with a size floor other nodes are left out of every set
+        const vector<int> unused;
+        const vector<int>& coreNumber = minCliqueSize > 1 || Visitor::boundsSize ? nodeCoreNumbers() : unused;
+       
+        // Process one node of the ordering; a visitor whose size floor
+        // rises during the search starts from the dense end
+        auto processNode = [&](int64_t step, int worker) {
+            PROFILE_ROOT();
+            int64_t position = Visitor::boundsSize ? nodeCount - 1 - step : step;
+            WorkerState& state = workerStates[worker];
+            int currentNode = nodeOrder[position];
+            int floor = searchFloor(visitors[worker], minCliqueSize);
+            auto outsideCore = [&](int node) { return !coreNumber.empty() && coreNumber[node] < floor - 1; };
+            if (outsideCore(currentNode)) {
+                return;
+            }
            
-            // Find later neighbors
-            candidateNodes.clear();
-            auto neighborIter = connections[currentNode].begin();
-            while (neighborIter != connections[currentNode].end()) {
-                int adjNode = *neighborIter;
-                if (nodePositions[adjNode] > idx) {
-                    candidateNodes.push_back(adjNode);
+            // After relabeling, the earlier and later neighbors are the two
+            // halves of the adjacency and are copied as they are
+            state.candidateNodes.clear();
+            state.excludedNodes.clear();
+            if (relabeled && coreNumber.empty()) {
+                NeighborRange later = graph.laterNeighbors(currentNode);
+                NeighborRange earlier = graph.earlierNeighbors(currentNode);
+                state.candidateNodes.assign(later.begin(), later.end());
+                state.excludedNodes.assign(earlier.begin(), earlier.end());
+            } else if (relabeled) {
+                for (int adjNode : graph.laterNeighbors(currentNode)) {
+                    if (!outsideCore(adjNode)) state.candidateNodes.push_back(adjNode);
+                }
+                for (int adjNode : graph.earlierNeighbors(currentNode)) {
+                    if (!outsideCore(adjNode)) state.excludedNodes.push_back(adjNode);
+                }
+            } else {
+                // Find later neighbors
+                NeighborRange adjacent = graph.neighbors(currentNode);
+                auto neighborIter = adjacent.begin();
+                while (neighborIter != adjacent.end()) {
+                    int adjNode = *neighborIter;
+                    if (nodePositions[adjNode] > position && !outsideCore(adjNode)) {
+                        state.candidateNodes.push_back(adjNode);
+                    }
+                    ++neighborIter;
+                }
+               
+                // Find earlier neighbors
+                neighborIter = adjacent.begin();
+                while (neighborIter != adjacent.end()) {
+                    int adjNode = *neighborIter;
+                    if (nodePositions[adjNode] < position && !outsideCore(adjNode)) {
+                        state.excludedNodes.push_back(adjNode);
+                    }
+                    ++neighborIter;
                 }
-                ++neighborIter;
             }
            
-            // Find earlier neighbors
-            excludedNodes.clear();
-            neighborIter = connections[currentNode].begin();
-            while (neighborIter != connections[currentNode].end()) {
-                int adjNode = *neighborIter;
-                if (nodePositions[adjNode] < idx) {
-                    excludedNodes.push_back(adjNode);
-                }
-                ++neighborIter;
+            if (1 + static_cast<int>(state.candidateNodes.size()) < floor) {
+                return;
             }
            
-            // Start recursive search
-            cliqueMembers.clear();
-            cliqueMembers.push_back(currentNode);
-            findCliquesRecursive(cliqueMembers, candidateNodes, excludedNodes);
-            idx++;
-        }
-       
-        auto endMoment = high_resolution_clock::now();
-        auto timeElapsed = duration_cast<milliseconds>(endMoment - startMoment);
+            // Start the search; a large neighborhood goes through the general
+            // recursion when its branches can be shared with idle workers
+            CliqueTrail<Visitor::needsMembers> clique(&currentNode, &currentNode + 1);
+            if (splitPool && splitPool->shouldSplit(state.candidateNodes.size())) {
+                searchEgoGraph(state, visitors, clique, state.candidateNodes, state.excludedNodes);
+            } else {
+                exploreSubproblem(state, visitors, clique, state.candidateNodes, state.excludedNodes);
+            }
+        };
        
-        // Print results
-        cout << "1. Largest Clique Size: " << largestCliqueSize << endl;
-        cout << "2. Total Number of Maximal Cliques: " << totalCliques << endl;
-        cout << "3. Execution Time: " << timeElapsed.count() << " ms" << endl;
-        cout << "4. Distribution of Clique Sizes:" << endl;
+        // Process each node in order, spread over workers when asked
+        PROFILE_PHASE(SEARCH);
+        if (searchWorkers == 1) {
+            idx = 0;
+            while (idx < nodeCount) {
+                processNode(idx, 0);
+                idx++;
+            }
+        } else {
+            WorkStealingPool pool(searchWorkers);
+            int64_t grain = max<int64_t>(1, min<int64_t>(256, nodeCount / (searchWorkers * 64)));
+            spawnRange(pool, 0, nodeCount, grain, processNode);
+            splitPool = &pool;
+            pool.run();
+            splitPool = nullptr;
+        }
        
-        int size = 1;
-        while (size <= largestCliqueSize) {
-            cout << "   - Cliques of size " << size << ": " << (sizeStats.count(size) ? sizeStats[size] : 0) << endl;
-            size++;
+        // Combine per-worker counts
+        for (const Visitor& visitor : visitors) {
+            visitor.addTo(cliqueTotals);
         }
     }
 
-private:
-    // Add a connection to the graph
-    void connectNodes(int origFirst, int origSecond) {
-        // Map to internal IDs
-        int first = getInternalId(origFirst);
-        int second = getInternalId(origSecond);
+    // The node order the search follows. When relabeling, the first call
+    // renumbers the graph so this order becomes 0..n-1: every node's later
+    // neighbors then follow it in its sorted adjacency, and nodes searched
+    // together are stored together
+    vector<int> searchOrder() {
+        vector<int> nodeOrder = static_cast<int>(storedOrder.size()) == nodeCount ? storedOrder : calculateOptimalOrder();
+        if (!relabelNodes || relabeled) {
+            return nodeOrder;
+        }
        
-        if (first < 0 || second < 0 || first >= nodeCount || second >= nodeCount) return;
+        vector<int> rank(nodeCount);
+        int position = 0;
+        while (position < nodeCount) {
+            rank[nodeOrder[position]] = position;
+            position++;
+        }
+        graph = graph.relabeled(rank, loaderThreads);
+        if (static_cast<int>(coreNumbers.size()) == nodeCount) {
+            vector<int> renamed(nodeCount);
+            position = 0;
+            while (position < nodeCount) {
+                renamed[rank[position]] = coreNumbers[position];
+                position++;
+            }
+            coreNumbers = move(renamed);
+        }
        
-        // Avoid duplicates
-        if (find(connections[first].begin(), connections[first].end(), second) == connections[first].end()) {
-            connections[first].push_back(second);
-            connections[second].push_back(first); // Undirected graph
+        // Carry the original IDs over to the new numbering; padding nodes
+        // get theirs first, so the map covers every node
+        assignOutputIds();
+        originalIds.assign(nodeCount, 0);
+        storedOrder.assign(nodeCount, 0);
+        position = 0;
+        while (position < nodeCount) {
+            originalIds[position] = outputIds[nodeOrder[position]];
+            storedOrder[position] = position;
+            position++;
         }
+        relabeled = true;
+        return storedOrder;
     }
-   
-    // Get or create internal ID
-    int getInternalId(int externalId) {
-        if (idMapper.find(externalId) == idMapper.end()) {
-            int newId = idMapper.size();
-            if (newId >= nodeCount) {
-                // Resize if needed
-                nodeCount = newId + 1;
-                connections.resize(nodeCount);
+
+    // Original IDs for output. Nodes that the header declares but no edge
+    // mentions have none, so they take the smallest IDs left unused
+    void assignOutputIds() {
+        outputIds = originalIds;
+        int candidateId = 0;
+        size_t next = 0;
+        while (static_cast<int>(outputIds.size()) < nodeCount) {
+            while (next < originalIds.size() && originalIds[next] < candidateId) next++;
+            if (next < originalIds.size() && originalIds[next] == candidateId) {
+                candidateId++;
+                continue;
             }
-            idMapper[externalId] = newId;
-            return newId;
+            outputIds.push_back(candidateId++);
         }
-        return idMapper[externalId];
     }
 
-    // Recursive clique finding algorithm
-    void findCliquesRecursive(vector<int>& currentClique, vector<int>& candidateNodes, vector<int>& excludedNodes) {
-        // Base case: found a maximal clique
-        if (candidateNodes.empty() && excludedNodes.empty()) {
-            int cliqueSize = currentClique.size();
-            totalCliques++;
-            sizeStats[cliqueSize]++;
-            largestCliqueSize = max(largestCliqueSize, cliqueSize);
+    // Map a snapshot in place of parsing a text file
+    bool restoreSnapshot(const string& snapshotFile) {
+        GraphSnapshot snapshot;
+        string error;
+        if (!loadGraphSnapshot(snapshotFile, snapshot, error)) {
+            cerr << "Error: Failed to load snapshot: " << error << endl;
+            return false;
+        }
+
+        graph = move(snapshot.graph);
+        nodeCount = graph.vertexCount();
+        storedOrder = move(snapshot.ordering);
+        originalIds = move(snapshot.originalIds);
+        cout << "Loaded graph with " << nodeCount << " nodes and " << graph.edgeCount() << " edges." << endl;
+        return true;
+    }
+
+    // Replace original IDs with zero-based internal IDs, assigned in
+    // ascending order of original ID. Returns the number of distinct IDs.
+    int assignInternalIds(EdgeListData& fileData, int workerCount) {
+        originalIds.clear();
+        if (fileData.edgeLines == 0) return 0;
+        vector<vector<pair<int, int>>>& blocks = fileData.edgeBlocks;
+        int blockCount = blocks.size();
+
+        int64_t firstId = fileData.minVertexId;
+        int64_t idRange = static_cast<int64_t>(fileData.maxVertexId) - firstId + 1;
+
+        if (idRange <= 4 * fileData.edgeLines + 1024) {
+            // Dense IDs: mark present values in a table, then number them
+            vector<int> internalIds(idRange, 0);
+            parallelFor(0, blockCount, workerCount, [&](int64_t lo, int64_t hi, int) {
+                for (int64_t b = lo; b < hi; b++) {
+                    for (const auto& link : blocks[b]) {
+                        __atomic_store_n(&internalIds[link.first - firstId], 1, __ATOMIC_RELAXED);
+                        __atomic_store_n(&internalIds[link.second - firstId], 1, __ATOMIC_RELAXED);
+                    }
+                }
+            });
+
+            for (int64_t offset = 0; offset < idRange; offset++) {
+                if (internalIds[offset]) {
+                    internalIds[offset] = originalIds.size();
+                    originalIds.push_back(static_cast<int>(firstId + offset));
+                }
+            }
+
+            parallelFor(0, blockCount, workerCount, [&](int64_t lo, int64_t hi, int) {
+                for (int64_t b = lo; b < hi; b++) {
+                    for (auto& link : blocks[b]) {
+                        link.first = internalIds[link.first - firstId];
+                        link.second = internalIds[link.second - firstId];
+                    }
+                }
+            });
+        } else {
+            // Sparse IDs: collect, sort and dedupe, then binary search
+            for (const auto& block : blocks) {
+                for (const auto& link : block) {
+                    originalIds.push_back(link.first);
+                    originalIds.push_back(link.second);
+                }
+            }
+            sort(originalIds.begin(), originalIds.end());
+            originalIds.erase(unique(originalIds.begin(), originalIds.end()), originalIds.end());
+
+            parallelFor(0, blockCount, workerCount, [&](int64_t lo, int64_t hi, int) {
+                for (int64_t b = lo; b < hi; b++) {
+                    for (auto& link : blocks[b]) {
+                        link.first = lower_bound(originalIds.begin(), originalIds.end(), link.first) - originalIds.begin();
+                        link.second = lower_bound(originalIds.begin(), originalIds.end(), link.second) - originalIds.begin();
+                    }
+                }
+            });
+        }
+        return originalIds.size();
+    }
+
+    // Solve a subproblem with the bitset kernel if it fits, otherwise with
+    // the general recursion over a copy of its ego subgraph
+    template <class Visitor>
+    void exploreSubproblem(WorkerState& state, vector<Visitor>& visitors, CliqueTrail<Visitor::needsMembers>& currentClique,
+                           vector<int>& candidateNodes, vector<int>& excludedNodes) {
+        if (state.bitKernel.build(graph, candidateNodes, excludedNodes)) {
+            enumerateInKernel(state.bitKernel, currentClique, visitors[currentWorker(state)], minCliqueSize);
+        } else {
+            searchEgoGraph(state, visitors, currentClique, candidateNodes, excludedNodes);
+        }
+    }
+
+    // Copy the part of the graph the subproblem can reach into the worker's
+    // ego subgraph and run the general recursion there, so that every
+    // intersection below walks short local adjacency lists. There is always
+    // a candidate here, as the kernel takes every subproblem without one.
+    // Handed-off branches only run once this call returns, so the copy is
+    // not rebuilt while it is still in use.
+    template <class Visitor>
+    void searchEgoGraph(WorkerState& state, vector<Visitor>& visitors, CliqueTrail<Visitor::needsMembers>& currentClique,
+                        const vector<int>& candidateNodes, const vector<int>& excludedNodes) {
+        state.egoGraph.build(graph, candidateNodes.data(), candidateNodes.size(), excludedNodes.data(), excludedNodes.size());
+        state.pivotScores.reset(state.egoGraph.graph().vertexCount());
+        vector<int> localCandidates = state.egoGraph.candidates();
+        vector<int> localExcluded = state.egoGraph.excluded();
+        findCliquesRecursive(state, visitors, currentClique, localCandidates, localExcluded);
+    }
+
+    // Same as exploreSubproblem, for a subproblem of the ego subgraph
+    template <class Visitor>
+    void exploreLocalSubproblem(WorkerState& state, vector<Visitor>& visitors, CliqueTrail<Visitor::needsMembers>& currentClique,
+                                vector<int>& candidateNodes, vector<int>& excludedNodes) {
+        if (state.bitKernel.build(state.egoGraph.graph(), candidateNodes, excludedNodes)) {
+            if (Visitor::needsMembers) state.bitKernel.mapVertices(state.egoGraph.graphIds());
+            enumerateInKernel(state.bitKernel, currentClique, visitors[currentWorker(state)], minCliqueSize);
+        } else {
+            findCliquesRecursive(state, visitors, currentClique, candidateNodes, excludedNodes);
+        }
+    }
+
+    // Recursive clique finding algorithm on the worker's ego subgraph; the
+    // node sets hold its local IDs, while currentClique grows and shrinks in
+    // place under graph IDs as branches are explored
+    template <class Visitor>
+    void findCliquesRecursive(WorkerState& state, vector<Visitor>& visitors, CliqueTrail<Visitor::needsMembers>& currentClique,
+                              vector<int>& candidateNodes, vector<int>& excludedNodes) {
+        const EgoSubgraph& ego = state.egoGraph;
+        // Too few candidates left to reach the minimum size
+        if (currentClique.size() + static_cast<int>(candidateNodes.size()) < searchFloor(visitors[currentWorker(state)], minCliqueSize)) {
             return;
         }
        
-        // Select pivot for optimization
-        vector<int> combinedSet;
-        combinedSet.insert(combinedSet.end(), candidateNodes.begin(), candidateNodes.end());
-        combinedSet.insert(combinedSet.end(), excludedNodes.begin(), excludedNodes.end());
+        PROFILE_NODE(currentClique.size());
+        state.searchNodes++;
        
-        int pivotNode = -1;
-        int bestCoverage = -1;
-        vector<int> tempNodes; // Reusable storage
+        // Base case: found a maximal clique
+        if (candidateNodes.empty() && excludedNodes.empty()) {
+            visitors[currentWorker(state)].visit(currentClique.data(), currentClique.size());
+            return;
+        }
        
-        auto nodeIter = combinedSet.begin();
-        while (nodeIter != combinedSet.end()) {
-            int testNode = *nodeIter;
-            findCommonNodes(testNode, candidateNodes, tempNodes);
-            if (static_cast<int>(tempNodes.size()) > bestCoverage) {
-                bestCoverage = tempNodes.size();
-                pivotNode = testNode;
-            }
-            ++nodeIter;
+        // Nothing left to branch on, and no pivot to pick
+        if (candidateNodes.empty()) {
+            return;
         }
        
+        // Select pivot for optimization
+        int pivotNode = pickPivot(pivotRule, ego.graph(), state.pivotScores, candidateNodes.data(), candidateNodes.size(),
+                                  excludedNodes.data(), excludedNodes.size());
+       
         // Find candidates not adjacent to pivot
         vector<int> pivotAdjacent;
-        findCommonNodes(pivotNode, candidateNodes, pivotAdjacent);
+        findCommonNodes(ego.graph(), pivotNode, candidateNodes, pivotAdjacent);
        
         // Make a copy for iteration
         vector<int> candidatesCopy = candidateNodes;
        
         // Work vectors for recursive calls
-        vector<int> expandedClique, filteredCandidates, filteredExcluded;
+        vector<int> filteredCandidates, filteredExcluded;
+       
+        // A big subtree while other workers are idle: hand each remaining
+        // branch to the pool as its own task rather than recursing here
+        bool handOff = splitPool && splitPool->shouldSplit(candidateNodes.size());
        
         // Process each relevant vertex
         auto vertexIter = candidatesCopy.begin();
         while (vertexIter != candidatesCopy.end()) {
             int vertex = *vertexIter;
-            if (find(pivotAdjacent.begin(), pivotAdjacent.end(), vertex) == pivotAdjacent.end()) {
+            if (!binary_search(pivotAdjacent.begin(), pivotAdjacent.end(), vertex)) {
                 // Prepare next recursive call parameters
-                expandedClique = currentClique;
-                expandedClique.push_back(vertex);
+                currentClique.push(ego.graphId(vertex));
                
                 // Filter candidates by adjacency
-                findCommonNodes(vertex, candidateNodes, filteredCandidates);
+                findCommonNodes(ego.graph(), vertex, candidateNodes, filteredCandidates);
                
                 // Filter excluded by adjacency
-                findCommonNodes(vertex, excludedNodes, filteredExcluded);
+                findCommonNodes(ego.graph(), vertex, excludedNodes, filteredExcluded);
                
-                findCliquesRecursive(expandedClique, filteredCandidates, filteredExcluded);
+                if (handOff) {
+                    // The task runs on whichever worker picks it up, so it
+                    // gets graph IDs; local IDs follow them, so both sets
+                    // stay sorted
+                    vector<Visitor>* allVisitors = &visitors;
+                    CliqueTrail<Visitor::needsMembers> expandedClique = currentClique;
+                    for (int& node : filteredCandidates) node = ego.graphId(node);
+                    for (int& node : filteredExcluded) node = ego.graphId(node);
+                    splitPool->spawn(currentWorker(state), [this, allVisitors, expandedClique, filteredCandidates, filteredExcluded](int worker) mutable {
+                        exploreSubproblem(workerStates[worker], *allVisitors, expandedClique, filteredCandidates, filteredExcluded);
+                    });
+                } else {
+                    exploreLocalSubproblem(state, visitors, currentClique, filteredCandidates, filteredExcluded);
+                }
+                currentClique.pop();
                
-                // Move processed vertex to excluded
-                candidateNodes.erase(remove(candidateNodes.begin(), candidateNodes.end(), vertex), candidateNodes.end());
-                excludedNodes.push_back(vertex);
+                // Move processed vertex to excluded, keeping both sorted
+                candidateNodes.erase(lower_bound(candidateNodes.begin(), candidateNodes.end(), vertex));
+                excludedNodes.insert(upper_bound(excludedNodes.begin(), excludedNodes.end(), vertex), vertex);
             }
             ++vertexIter;
         }
     }
 
-    // Find adjacent nodes that are in a given set
-    void findCommonNodes(int vertex, const vector<int>& nodeSet, vector<int>& resultNodes) {
-        resultNodes.clear();
-       
-        // Choose approach based on set size
-        if (nodeSet.size() > 10) { // Threshold for optimization
-            unordered_set<int> fastLookup(nodeSet.begin(), nodeSet.end());
-           
-            auto neighborIter = connections[vertex].begin();
-            while (neighborIter != connections[vertex].end()) {
-                int adjNode = *neighborIter;
-                if (fastLookup.find(adjNode) != fastLookup.end()) {
-                    resultNodes.push_back(adjNode);
-                }
-                ++neighborIter;
-            }
-        } else {
-            // For smaller sets, simple search
-            auto neighborIter = connections[vertex].begin();
-            while (neighborIter != connections[vertex].end()) {
-                int adjNode = *neighborIter;
-                if (find(nodeSet.begin(), nodeSet.end(), adjNode) != nodeSet.end()) {
-                    resultNodes.push_back(adjNode);
-                }
-                ++neighborIter;
-            }
-        }
+    // Find adjacent nodes that are in a given set (sorted ascending)
+    void findCommonNodes(const CSRGraph& subgraph, int vertex, const vector<int>& nodeSet, vector<int>& resultNodes) {
+        NeighborRange adjacent = subgraph.neighbors(vertex);
+        intersectInto(adjacent.begin(), adjacent.size(), nodeSet.data(), nodeSet.size(), resultNodes);
     }
 
-    // Compute the optimal vertex ordering for efficiency
+    // Degeneracy order by peeling minimum-degree nodes first; the core
+    // numbers found on the way are kept for size-floor pruning
     vector<int> calculateOptimalOrder() {
-        vector<int> result;
-        vector<int> nodeDegrees(nodeCount);
-        vector<bool> alreadyProcessed(nodeCount, false);
-       
-        // Compute initial node degrees
-        int currentNode = 0;
-        while (currentNode < nodeCount) {
-            nodeDegrees[currentNode] = connections[currentNode].size();
-            currentNode++;
-        }
-       
-        // Use counting sort approach for better performance
-        int maxDegreeFound = 0;
-        vector<int>::iterator degreeIter = nodeDegrees.begin();
-        while (degreeIter != nodeDegrees.end()) {
-            maxDegreeFound = max(maxDegreeFound, *degreeIter);
-            ++degreeIter;
-        }
-       
-        vector<vector<int>> degreeGroups(maxDegreeFound + 1);
-        currentNode = 0;
-        while (currentNode < nodeCount) {
-            degreeGroups[nodeDegrees[currentNode]].push_back(currentNode);
-            currentNode++;
-        }
-       
-        // Process nodes by ascending degree
-        int currentDegree = 0;
-        while (currentDegree <= maxDegreeFound) {
-            while (!degreeGroups[currentDegree].empty()) {
-                int vertex = degreeGroups[currentDegree].back();
-                degreeGroups[currentDegree].pop_back();
-               
-                if (alreadyProcessed[vertex]) continue;
-               
-                // Add to result and mark
-                result.push_back(vertex);
-                alreadyProcessed[vertex] = true;
-               
-                // Update degrees of remaining neighbors
-                auto neighborIter = connections[vertex].begin();
-                while (neighborIter != connections[vertex].end()) {
-                    int adjacentNode = *neighborIter;
-                    if (!alreadyProcessed[adjacentNode]) {
-                        int prevDegree = nodeDegrees[adjacentNode];
-                        nodeDegrees[adjacentNode]--;
-                       
-                        if (prevDegree > nodeDegrees[adjacentNode]) {
-                            // Move to appropriate degree group
-                            degreeGroups[nodeDegrees[adjacentNode]].push_back(adjacentNode);
-                        }
-                    }
-                    ++neighborIter;
-                }
-            }
-            currentDegree++;
+        CoreDecomposition cores = decomposeCores(graph, loaderThreads);
+        coreNumbers = move(cores.coreNumber);
+        return move(cores.order);
+    }
+
+    // Core numbers of the current graph; peeled here when the order was
+    // read from a snapshot
+    const vector<int>& nodeCoreNumbers() {
+        if (static_cast<int>(coreNumbers.size()) != nodeCount) {
+            coreNumbers = computeCoreNumbers(graph, loaderThreads);
         }
-       
-        return result;
+        return coreNumbers;
     }
 
     // Data members
-    vector<vector<int>> connections;
+    CSRGraph graph;
     int nodeCount;
-    int largestCliqueSize;
-    int totalCliques;
-    map<int, int> sizeStats;
-    unordered_map<int, int> idMapper; // For mapping original IDs to zero-based indices
+    int loaderThreads;
+    int searchWorkers;
+    int minCliqueSize; // Smallest clique size searched for
+    bool relabelNodes; // Renumber nodes in search order before searching
+    PivotRule pivotRule; // How each search frame picks its pivot
+    bool relabeled; // Set once the graph has been renumbered
+    CliqueCounters cliqueTotals;
+    vector<WorkerState> workerStates;
+    WorkStealingPool* splitPool; // Set while a parallel search is running
+    vector<int> originalIds; // Original ID of each zero-based internal index
+    vector<int> outputIds; // originalIds extended over nodes without edges
+    vector<int> storedOrder; // Node order read from or written to a snapshot
+    vector<int> coreNumbers; // Core number of each node, from the last peel
 };
 
 int main(int argc, char* argv[]) {
     GraphCliqueAnalyzer analyzer;
    
-    string inputFile = "Email-Enron.txt";  // Default filename
-    if (argc > 1) {
-        inputFile = argv[1];
+    // Input file defaults to Email-Enron.txt
+    RunOptions options;
+    if (!parseRunOptions(argc, argv, options)) {
+        return 1;
+    }
+    kernelSelection();  // calibrate on this host before anything is timed
+    analyzer.configureThreads(options.loadThreads(), options.searchThreads());
+    analyzer.setMinimumCliqueSize(options.minSize);
+    analyzer.setRelabel(options.relabel);
+    analyzer.setPivotRule(options.pivotRule);
+    if (options.engine != "bk") {
+        cerr << "Unknown engine: " << options.engine << endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (!options.checkpointFile.empty()) {
+        cerr << "--checkpoint is not supported by this finder" << endl;
+        return 1;
+    }
+    CliqueSink sink;
+    if (!openCliqueOutput(options, sink)) {
+        return 1;
     }
    
-    analyzer.buildGraphFromFile(inputFile);
-    analyzer.analyzeGraph();
+    if (!analyzer.buildGraphFromFile(options.inputFile)) {
+        return 1;
+    }
+    if (!options.snapshotOutput.empty() && !analyzer.storeSnapshot(options.snapshotOutput)) {
+        return 1;
+    }
+    if (options.maxClique) {
+        analyzer.findLargestClique(sink.isOpen() ? &sink : nullptr);
+    } else if (options.topCount > 0) {
+        analyzer.findTopCliques(options.topCount, sink.isOpen() ? &sink : nullptr);
+    } else {
+        analyzer.analyzeGraph(sink.isOpen() ? &sink : nullptr);
+    }
+    if (!closeCliqueOutput(options, sink)) {
+        return 1;
+    }
+    PROFILE_REPORT();
    
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,182 @@
+#ifndef GRAPH_GENERATORS_H
+#define GRAPH_GENERATORS_H
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+
+// Seeded synthetic graphs for benchmarks. Each generator returns simple
+// undirected edges (u < v, no duplicates) over vertices 0..n-1, and the same
+// seed always gives the same graph.
+struct GeneratedGraph {
+    std::string name;
+    int vertexCount = 0;
+    std::vector<std::pair<int, int>> edges;
+};
+
+namespace graphgen {
+
+inline void normalize(GeneratedGraph& g) {
+    for (auto& e : g.edges) {
+        if (e.first > e.second) std::swap(e.first, e.second);
+    }
+    g.edges.erase(std::remove_if(g.edges.begin(), g.edges.end(),
+                                 [](const std::pair<int, int>& e) { return e.first == e.second; }),
+                  g.edges.end());
+    std::sort(g.edges.begin(), g.edges.end());
+    g.edges.erase(std::unique(g.edges.begin(), g.edges.end()), g.edges.end());
+}
+
+// G(n, p): every pair independently with probability p. Pairs are walked in
+// order and the gap to the next chosen one is drawn from the geometric
+// distribution (Batagelj-Brandes), so the cost is O(n + m) rather than O(n^2).
+inline GeneratedGraph erdosRenyi(int n, double p, uint64_t seed) {
+    GeneratedGraph g;
+    g.name = "erdos-renyi";
+    g.vertexCount = n;
+    if (n < 2 || p <= 0) return g;
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    double logMiss = std::log(1.0 - std::min(p, 1.0 - 1e-12));
+    int64_t v = 1, w = -1;
+    while (v < n) {
+        double r = unit(rng);
+        w += 1 + static_cast<int64_t>(std::floor(std::log(1.0 - r) / logMiss));
+        while (w >= v && v < n) {
+            w -= v;
+            v++;
+        }
+        if (v < n) g.edges.emplace_back(static_cast<int>(w), static_cast<int>(v));
+    }
+    return g;
+}
+
+// Preferential attachment: each new vertex links to m distinct earlier
+// vertices chosen with probability proportional to their degree. Starts from
+// a clique on m + 1 vertices.
+inline GeneratedGraph barabasiAlbert(int n, int m, uint64_t seed) {
+    GeneratedGraph g;
+    g.name = "barabasi-albert";
+    g.vertexCount = n;
+    if (n < 2 || m < 1) return g;
+    std::mt19937_64 rng(seed);
+    int seedSize = std::min(n, m + 1);
+    // Every edge endpoint once, so a uniform pick is degree-proportional
+    std::vector<int> endpoints;
+    for (int u = 0; u < seedSize; u++) {
+        for (int v = u + 1; v < seedSize; v++) {
+            g.edges.emplace_back(u, v);
+            endpoints.push_back(u);
+            endpoints.push_back(v);
+        }
+    }
+    std::vector<int> targets;
+    for (int v = seedSize; v < n; v++) {
+        targets.clear();
+        std::uniform_int_distribution<size_t> pick(0, endpoints.size() - 1);
+        while (static_cast<int>(targets.size()) < m) {
+            int t = endpoints[pick(rng)];
+            if (std::find(targets.begin(), targets.end(), t) == targets.end()) targets.push_back(t);
+        }
+        for (int t : targets) {
+            g.edges.emplace_back(t, v);
+            endpoints.push_back(t);
+            endpoints.push_back(v);
+        }
+    }
+    normalize(g);
+    return g;
+}
+
+// Moon-Moser graph: the complete k-partite graph with parts of three. It has
+// 3^k maximal cliques, each of size k, the most any graph on 3k vertices can
+// have, so it is the worst case for output-sensitive enumeration.
+inline GeneratedGraph moonMoser(int k) {
+    GeneratedGraph g;
+    g.name = "moon-moser";
+    g.vertexCount = 3 * std::max(0, k);
+    for (int u = 0; u < g.vertexCount; u++) {
+        for (int v = u + 1; v < g.vertexCount; v++) {
+            if (u / 3 != v / 3) g.edges.emplace_back(u, v);
+        }
+    }
+    return g;
+}
+
+// G(n, p) background with count cliques of cliqueSize vertices planted on
+// random vertex sets.
+inline GeneratedGraph plantedCliques(int n, double p, int count, int cliqueSize, uint64_t seed) {
+    GeneratedGraph g = erdosRenyi(n, p, seed);
+    g.name = "planted";
+    std::mt19937_64 rng(seed ^ 0x9e3779b97f4a7c15ULL);
+    std::vector<int> vertices(n);
+    for (int v = 0; v < n; v++) vertices[v] = v;
+    int size = std::min(cliqueSize, n);
+    for (int c = 0; c < count; c++) {
+        // Partial Fisher-Yates: the first size slots become the clique
+        for (int i = 0; i < size; i++) {
+            std::uniform_int_distribution<int> pick(i, n - 1);
+            std::swap(vertices[i], vertices[pick(rng)]);
+        }
+        for (int i = 0; i < size; i++) {
+            for (int j = i + 1; j < size; j++) g.edges.emplace_back(vertices[i], vertices[j]);
+        }
+    }
+    normalize(g);
+    return g;
+}
+
+// R-MAT over 2^scale vertices with edgeFactor * 2^scale edge draws: each
+// edge picks a quadrant of the adjacency matrix with probabilities a, b, c
+// and 1 - a - b - c, scale times. The Graph500 parameters are the default.
+// Self-loops and repeated draws are dropped, so there are somewhat fewer
+// edges than draws.
+inline GeneratedGraph rmat(int scale, int edgeFactor, uint64_t seed, double a = 0.57, double b = 0.19,
+                           double c = 0.19) {
+    GeneratedGraph g;
+    g.name = "rmat";
+    g.vertexCount = 1 << scale;
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    int64_t draws = static_cast<int64_t>(edgeFactor) << scale;
+    g.edges.reserve(draws);
+    for (int64_t e = 0; e < draws; e++) {
+        int u = 0, v = 0;
+        for (int bit = scale - 1; bit >= 0; bit--) {
+            double r = unit(rng);
+            if (r < a) {
+            } else if (r < a + b) {
+                v |= 1 << bit;
+            } else if (r < a + b + c) {
+                u |= 1 << bit;
+            } else {
+                u |= 1 << bit;
+                v |= 1 << bit;
+            }
+        }
+        g.edges.emplace_back(u, v);
+    }
+    normalize(g);
+    return g;
+}
+
+}  // namespace graphgen
+
+// Writes g as a SNAP-style edge list that all the clique finders read, with
+// the vertex count in the header so isolated vertices are kept.
+inline bool writeEdgeList(const GeneratedGraph& g, const std::string& path) {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) return false;
+    std::fprintf(file, "# Undirected graph: %s\n", g.name.c_str());
+    std::fprintf(file, "# Nodes: %d Edges: %zu\n", g.vertexCount, g.edges.size());
+    std::fprintf(file, "# FromNodeId\tToNodeId\n");
+    for (const auto& e : g.edges) std::fprintf(file, "%d\t%d\n", e.first, e.second);
+    return std::fclose(file) == 0;
+}
+
+#endif
@@ -0,0 +1,233 @@
+#ifndef GRAPH_SNAPSHOT_H
+#define GRAPH_SNAPSHOT_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <unistd.h>
+
+#include "csr_graph.h"
+#include "mapped_file.h"
+
+// Binary graph snapshot, written in native byte order:
+//
+//   SnapshotHeader
+//   offsets      int64[vertexCount + 1]
+//   targets      int32[targetCount]
+//   ordering     int32[vertexCount]   if SNAPSHOT_HAS_ORDERING
+//   originalIds  int32[vertexCount]   if SNAPSHOT_HAS_ORIGINAL_IDS
+//
+// Every section starts on a 64-byte boundary so a mapped file can be used in
+// place. Bump SNAPSHOT_VERSION whenever the layout changes.
+
+const char SNAPSHOT_MAGIC[8] = {'C', 'L', 'Q', 'G', 'R', 'A', 'P', 'H'};
+const uint32_t SNAPSHOT_VERSION = 1;
+const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+enum SnapshotFlags : uint32_t {
+    SNAPSHOT_HAS_ORDERING = 1u << 0,
+    SNAPSHOT_HAS_ORIGINAL_IDS = 1u << 1
+};
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t flags;
+    uint32_t reserved;
+    int64_t vertexCount;
+    int64_t targetCount;
+    int64_t offsetsPosition;
+    int64_t targetsPosition;
+    int64_t orderingPosition;
+    int64_t originalIdsPosition;
+};
+
+// Graph loaded from a snapshot. The graph's arrays point into the mapping;
+// the optional sections are copied out.
+struct GraphSnapshot {
+    CSRGraph graph;
+    std::vector<int> ordering;
+    std::vector<int> originalIds;
+};
+
+namespace snapshotdetail {
+
+inline int64_t alignSection(int64_t position) { return (position + 63) & ~int64_t(63); }
+
+inline bool writeSection(FILE* out, int64_t& position, int64_t target, const void* data, size_t bytes) {
+    static const char padding[64] = {0};
+    if (target > position && fwrite(padding, 1, target - position, out) != static_cast<size_t>(target - position)) {
+        return false;
+    }
+    if (bytes > 0 && fwrite(data, 1, bytes, out) != bytes) return false;
+    position = target + static_cast<int64_t>(bytes);
+    return true;
+}
+
+}
+
+// True if the file starts with the snapshot magic bytes.
+inline bool isGraphSnapshot(const std::string& path) {
+    FILE* in = fopen(path.c_str(), "rb");
+    if (!in) return false;
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    bool match = fread(magic, 1, sizeof(magic), in) == sizeof(magic) &&
+                 memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0;
+    fclose(in);
+    return match;
+}
+
+// Writes graph and the optional per-vertex sections (pass nullptr or an empty
+// vector to leave one out). The file is written under a temporary name,
+// synced and renamed into place, so readers never see a partial snapshot,
+// not even after a crash.
+inline bool saveGraphSnapshot(const std::string& path, const CSRGraph& graph,
+                              const std::vector<int>* ordering, const std::vector<int>* originalIds,
+                              std::string& error) {
+    int64_t n = graph.vertexCount();
+    bool withOrdering = ordering && static_cast<int64_t>(ordering->size()) == n && n > 0;
+    bool withOriginalIds = originalIds && static_cast<int64_t>(originalIds->size()) == n && n > 0;
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.flags = (withOrdering ? uint32_t(SNAPSHOT_HAS_ORDERING) : 0u) | (withOriginalIds ? uint32_t(SNAPSHOT_HAS_ORIGINAL_IDS) : 0u);
+    header.vertexCount = n;
+    header.targetCount = graph.directedEdgeCount();
+    header.offsetsPosition = snapshotdetail::alignSection(sizeof(SnapshotHeader));
+    header.targetsPosition = snapshotdetail::alignSection(header.offsetsPosition + (n + 1) * sizeof(int64_t));
+    int64_t next = snapshotdetail::alignSection(header.targetsPosition + header.targetCount * sizeof(int));
+    if (withOrdering) {
+        header.orderingPosition = next;
+        next = snapshotdetail::alignSection(next + n * sizeof(int));
+    }
+    if (withOriginalIds) {
+        header.originalIdsPosition = next;
+    }
+
+    std::string temporaryPath = path + ".tmp";
+    FILE* out = fopen(temporaryPath.c_str(), "wb");
+    if (!out) {
+        error = "cannot create " + temporaryPath;
+        return false;
+    }
+
+    int64_t position = 0;
+    bool ok = snapshotdetail::writeSection(out, position, 0, &header, sizeof(header)) &&
+              snapshotdetail::writeSection(out, position, header.offsetsPosition, graph.offsetData(),
+                                           (n + 1) * sizeof(int64_t)) &&
+              snapshotdetail::writeSection(out, position, header.targetsPosition, graph.targetData(),
+                                           header.targetCount * sizeof(int));
+    if (ok && withOrdering) {
+        ok = snapshotdetail::writeSection(out, position, header.orderingPosition, ordering->data(), n * sizeof(int));
+    }
+    if (ok && withOriginalIds) {
+        ok = snapshotdetail::writeSection(out, position, header.originalIdsPosition, originalIds->data(), n * sizeof(int));
+    }
+    ok = ok && fflush(out) == 0 && fsync(fileno(out)) == 0;
+    ok = (fclose(out) == 0) && ok;
+
+    if (!ok || rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        remove(temporaryPath.c_str());
+        error = "failed writing " + path;
+        return false;
+    }
+    return true;
+}
+
+// Maps a snapshot and exposes its adjacency without copying it.
+inline bool loadGraphSnapshot(const std::string& path, GraphSnapshot& snapshot, std::string& error) {
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+    if (!file->open(path, MADV_NORMAL)) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    SnapshotHeader header;
+    if (file->size() < sizeof(header)) {
+        error = path + " is too short to be a snapshot";
+        return false;
+    }
+    memcpy(&header, file->data(), sizeof(header));
+
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        error = path + " is not a graph snapshot";
+        return false;
+    }
+    if (header.version != SNAPSHOT_VERSION) {
+        error = path + " has unsupported snapshot version " + std::to_string(header.version);
+        return false;
+    }
+    if (header.byteOrder != SNAPSHOT_BYTE_ORDER) {
+        error = path + " was written with a different byte order";
+        return false;
+    }
+
+    int64_t n = header.vertexCount;
+    int64_t size = static_cast<int64_t>(file->size());
+    // Whether count elements of elementSize bytes lie inside the file from
+    // position. Divides instead of multiplying, so no count can wrap around.
+    auto fits = [&](int64_t position, int64_t count, int64_t elementSize) {
+        return position >= 0 && position % 64 == 0 && position <= size && count >= 0 &&
+               count <= (size - position) / elementSize;
+    };
+    bool withOrdering = header.flags & SNAPSHOT_HAS_ORDERING;
+    bool withOriginalIds = header.flags & SNAPSHOT_HAS_ORIGINAL_IDS;
+    if (n < 0 || n > INT32_MAX ||
+        !fits(header.offsetsPosition, n + 1, sizeof(int64_t)) ||
+        !fits(header.targetsPosition, header.targetCount, sizeof(int)) ||
+        (withOrdering && !fits(header.orderingPosition, n, sizeof(int))) ||
+        (withOriginalIds && !fits(header.originalIdsPosition, n, sizeof(int)))) {
+        error = path + " is truncated or corrupt";
+        return false;
+    }
+
+    const char* base = file->data();
+    const int64_t* offsets = reinterpret_cast<const int64_t*>(base + header.offsetsPosition);
+    const int* targets = reinterpret_cast<const int*>(base + header.targetsPosition);
+    // One pass over the arrays, so that a damaged file is refused here
+    // instead of sending a search out of bounds.
+    if (offsets[0] != 0 || offsets[n] != header.targetCount) {
+        error = path + " has inconsistent offsets";
+        return false;
+    }
+    for (int64_t v = 0; v < n; v++) {
+        if (offsets[v + 1] < offsets[v]) {
+            error = path + " has inconsistent offsets";
+            return false;
+        }
+    }
+    for (int64_t i = 0; i < header.targetCount; i++) {
+        if (targets[i] < 0 || targets[i] >= n) {
+            error = path + " is truncated or corrupt";
+            return false;
+        }
+    }
+
+    snapshot.ordering.clear();
+    snapshot.originalIds.clear();
+    if (withOrdering) {
+        const int* ordering = reinterpret_cast<const int*>(base + header.orderingPosition);
+        snapshot.ordering.assign(ordering, ordering + n);
+        for (int v : snapshot.ordering) {
+            if (v < 0 || v >= n) {
+                error = path + " is truncated or corrupt";
+                return false;
+            }
+        }
+    }
+    if (withOriginalIds) {
+        const int* originalIds = reinterpret_cast<const int*>(base + header.originalIdsPosition);
+        snapshot.originalIds.assign(originalIds, originalIds + n);
+    }
+    snapshot.graph = CSRGraph::fromExternalArrays(static_cast<int>(n), offsets, targets, file);
+    return true;
+}
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef KERNEL_SELECT_H
+#define KERNEL_SELECT_H
+
+#include <vector>
+#include <algorithm>
+#include <ostream>
+#include <cstdint>
+
+#include "set_ops.h"
+
+// Chooses, per subproblem, between the bitset kernel and the sorted-array
+// search. A k-vertex subproblem costs k/64 words per bitset intersection
+// whatever its density, while a sorted intersection walks lists of about
+// density * k vertices, so the bitset only pays off above some density.
+// That density is set by timing both on this host, once, at first use; the
+// sorted side also brings its own galloping cutoff (see set_ops.h).
+
+struct KernelSelection {
+    const char* blockKernel;  // sorted-array intersection kernel
+    size_t gallopRatio;       // size ratio from which sorted arrays gallop
+    double bitsetMinDensity;  // bitset kernel from this density up
+};
+
+// Subproblems of at most one word always go to the bitset kernel.
+const int ALWAYS_BITSET_VERTICES = 64;
+
+namespace kernelselect {
+
+// Nanoseconds per word of an AND and popcount over two bit rows.
+inline double timeBitsetWord() {
+    const int words = 256;
+    std::vector<uint64_t> a(words), b(words);
+    for (int i = 0; i < words; i++) {
+        a[i] = 0x9e3779b97f4a7c15ull * (i + 1);
+        b[i] = 0xc2b2ae3d27d4eb4full * (i + 7);
+    }
+    volatile uint64_t sink = 0;
+    double nanos = setops::bestNanosPerCall([&] {
+        uint64_t count = 0;
+        for (int i = 0; i < words; i++) count += __builtin_popcountll(a[i] & b[i]);
+        sink = sink + count;
+    }, 2048);
+    return nanos / words;
+}
+
+// Nanoseconds per input element of an equal-size sorted intersection.
+inline double timeSortedElement() {
+    const int size = 512;
+    std::vector<int> a(size), b(size), out(size);
+    for (int i = 0; i < size; i++) {
+        a[i] = 3 * i;
+        b[i] = 3 * i + (i % 2) * 2;
+    }
+    setops::IntersectFn block = setops::activeKernel().block;
+    volatile size_t sink = 0;
+    double nanos = setops::bestNanosPerCall([&] { sink = sink + block(a.data(), size, b.data(), size, out.data()); }, 2048);
+    return nanos / (2 * size);
+}
+
+// Equal cost when k/64 words match 2 * density * k elements, clamped so a
+// bad measurement cannot push everything to one side.
+inline KernelSelection calibrate() {
+    const setops::KernelChoice& sorted = setops::activeKernel();
+    double density = timeBitsetWord() / (128 * timeSortedElement());
+    return KernelSelection{sorted.name, sorted.gallopRatio, std::min(0.25, std::max(0.002, density))};
+}
+
+}
+
+inline const KernelSelection& kernelSelection() {
+    static const KernelSelection selection = kernelselect::calibrate();
+    return selection;
+}
+
+// Whether a subproblem of localCount vertices, of which candidateCount are
+// candidates with candidateEdges neighbor entries among the localCount, is
+// dense enough for the bitset kernel.
+inline bool preferBitset(int localCount, int candidateCount, int64_t candidateEdges) {
+    if (localCount <= ALWAYS_BITSET_VERTICES || candidateCount == 0) return true;
+    double density = static_cast<double>(candidateEdges) / (static_cast<double>(candidateCount) * localCount);
+    return density >= kernelSelection().bitsetMinDensity;
+}
+
+// How many subproblems went to each engine; one per worker, merged at the end.
+struct KernelUsage {
+    int64_t bitset = 0;
+    int64_t sparse = 0;    // sorted arrays: below the density cutoff
+    int64_t oversize = 0;  // sorted arrays: too large for the bitset
+
+    void merge(const KernelUsage& other) {
+        bitset += other.bitset;
+        sparse += other.sparse;
+        oversize += other.oversize;
+    }
+};
+
+// One line: the counts, then the calibrated choices behind them.
+inline void printKernelUsage(std::ostream& out, const KernelUsage& usage) {
+    const KernelSelection& selection = kernelSelection();
+    out << "bitset " << usage.bitset << ", sorted arrays " << usage.sparse + usage.oversize
+        << " (" << usage.sparse << " sparse, " << usage.oversize << " oversize); "
+        << "bitset from density " << selection.bitsetMinDensity << ", " << selection.blockKernel
+        << " intersections, galloping from size ratio " << selection.gallopRatio << std::endl;
+}
+
+#endif
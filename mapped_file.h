@@ -0,0 +1,61 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Read-only memory mapping of a whole file.
+class MappedFile {
+public:
+    MappedFile() : bytes(nullptr), length(0) {}
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // advice is passed to madvise, e.g. MADV_SEQUENTIAL for a one-pass scan.
+    bool open(const std::string& path, int advice = MADV_SEQUENTIAL) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            ::close(fd);
+            return false;
+        }
+        length = static_cast<size_t>(info.st_size);
+        if (length > 0) {
+            void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                ::close(fd);
+                length = 0;
+                return false;
+            }
+            bytes = static_cast<const char*>(mapped);
+            madvise(mapped, length, advice);
+        }
+        ::close(fd);
+        return true;
+    }
+
+    void close() {
+        if (bytes) munmap(const_cast<char*>(bytes), length);
+        bytes = nullptr;
+        length = 0;
+    }
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const char* bytes;
+    size_t length;
+};
+
+#endif
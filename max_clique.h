@@ -0,0 +1,226 @@
+#ifndef MAX_CLIQUE_H
+#define MAX_CLIQUE_H
+
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+#include <cstdint>
+
+#include "csr_graph.h"
+#include "work_stealing.h"
+#include "degeneracy.h"
+#include "profiling.h"
+
+// Branch and bound for one maximum clique, for runs that only want its size.
+// Each vertex of the ordering roots a search over its later neighbors, so a
+// clique is found from its earliest vertex. Roots are taken from the end of
+// the ordering, where the densest core sits, so a large incumbent turns up
+// early. The incumbent size is shared by all workers, and three bounds prune
+// against it:
+//   core number  a vertex of core number c lies in no clique larger than
+//                c + 1, so such roots and candidates are dropped;
+//   size         1 + |P| for a root;
+//   coloring     a clique takes at most one vertex of each color class, so
+//                |R| plus the greedy color of a branch bounds its subtree.
+// Below the root the candidates live in a bit matrix over local IDs and the
+// coloring is the bitset scheme of San Segundo's BBMC.
+class MaxCliqueSearch {
+public:
+    // knownCoreNumbers, if given, holds the core number of every vertex of g
+    // and saves run() from peeling g again.
+    MaxCliqueSearch(const CSRGraph& g, const std::vector<int>& vertexOrder, int workerCount,
+                    const std::vector<int>* knownCoreNumbers = nullptr)
+        : graph(g), ordering(vertexOrder), workers(std::max(1, workerCount)), givenCoreNumbers(knownCoreNumbers),
+          bestSize(0) {}
+
+    // Returns the members of a maximum clique (empty for an empty graph).
+    std::vector<int> run() {
+        int n = graph.vertexCount();
+        bestSize.store(0);
+        bestMembers.clear();
+        if (n == 0) return bestMembers;
+
+        if (givenCoreNumbers && static_cast<int>(givenCoreNumbers->size()) == n) {
+            coreNumber = *givenCoreNumbers;
+        } else {
+            coreNumber = computeCoreNumbers(graph, workers);
+        }
+        position.assign(n, 0);
+        for (int i = 0; i < n; i++) position[ordering[i]] = i;
+
+        PROFILE_PHASE(SEARCH);
+        std::vector<Worker> states(workers);
+        auto searchRoot = [&](int64_t step, int worker) { searchFrom(states[worker], n - 1 - static_cast<int>(step)); };
+        if (workers == 1) {
+            for (int64_t step = 0; step < n; step++) searchRoot(step, 0);
+        } else {
+            WorkStealingPool pool(workers);
+            int64_t grain = std::max<int64_t>(1, std::min<int64_t>(64, n / (workers * 64)));
+            spawnRange(pool, 0, n, grain, searchRoot);
+            pool.run();
+        }
+        return bestMembers;
+    }
+
+    // Core number of every vertex, as computed by the last run().
+    const std::vector<int>& coreNumbers() const { return coreNumber; }
+
+private:
+    // Per-depth candidate set plus the branch order and colors found for it.
+    struct Level {
+        std::vector<uint64_t> candidates;
+        std::vector<int> branches;
+        std::vector<int> colors;
+    };
+
+    struct Worker {
+        std::vector<int> localVertices;  // local ID -> graph vertex
+        std::vector<uint64_t> rows;
+        int wordCount = 0;
+        std::vector<Level> levels;
+        std::vector<uint64_t> uncolored, colorClass;
+        std::vector<int> chosen;         // local IDs below the root
+        int root = -1;
+    };
+
+    static uint64_t* row(Worker& w, int v) { return w.rows.data() + static_cast<size_t>(v) * w.wordCount; }
+    static void setBit(uint64_t* set, int i) { set[i >> 6] |= uint64_t(1) << (i & 63); }
+    static void clearBit(uint64_t* set, int i) { set[i >> 6] &= ~(uint64_t(1) << (i & 63)); }
+
+    void searchFrom(Worker& w, int rootPosition) {
+        PROFILE_ROOT();
+        int v = ordering[rootPosition];
+        int best = bestSize.load(std::memory_order_relaxed);
+        if (coreNumber[v] + 1 <= best) return;
+
+        // Only later neighbors that could sit in a clique of size best + 1
+        w.localVertices.clear();
+        for (int u : graph.neighbors(v)) {
+            if (position[u] > rootPosition && coreNumber[u] >= best) w.localVertices.push_back(u);
+        }
+        int k = static_cast<int>(w.localVertices.size());
+        if (k + 1 <= best) return;
+        w.root = v;
+        w.chosen.clear();
+        if (k == 0) {
+            offer(w, 1);
+            return;
+        }
+
+        // Local IDs follow the ascending candidate list, so each row comes
+        // from merging a neighbor list with the candidates after it
+        w.wordCount = (k + 63) / 64;
+        w.rows.assign(static_cast<size_t>(k) * w.wordCount, 0);
+        const int* local = w.localVertices.data();
+        for (int i = 0; i < k; i++) {
+            NeighborRange adjacent = graph.neighbors(local[i]);
+            const int* a = std::upper_bound(adjacent.begin(), adjacent.end(), local[i]);
+            int j = i + 1;
+            while (a != adjacent.end() && j < k) {
+                if (*a < local[j]) {
+                    a++;
+                } else if (local[j] < *a) {
+                    j++;
+                } else {
+                    setBit(row(w, i), j);
+                    setBit(row(w, j), i);
+                    a++;
+                    j++;
+                }
+            }
+        }
+
+        // Depth never exceeds k; sized up front so no level moves
+        if (static_cast<int>(w.levels.size()) < k + 1) w.levels.resize(k + 1);
+        for (int d = 0; d <= k; d++) w.levels[d].candidates.assign(w.wordCount, 0);
+        w.uncolored.assign(w.wordCount, 0);
+        w.colorClass.assign(w.wordCount, 0);
+        for (int i = 0; i < k; i++) setBit(w.levels[0].candidates.data(), i);
+        expand(w, 0);
+    }
+
+    // Greedy sequential coloring of P one color class at a time. Only
+    // vertices whose color reaches minColor can lead past the incumbent, so
+    // only those are listed, in ascending color order.
+    void colorCandidates(Worker& w, Level& level, int minColor) {
+        level.branches.clear();
+        level.colors.clear();
+        uint64_t* Q = w.uncolored.data();
+        uint64_t* U = w.colorClass.data();
+        const uint64_t* P = level.candidates.data();
+        int remaining = 0;
+        for (int i = 0; i < w.wordCount; i++) {
+            Q[i] = P[i];
+            remaining += __builtin_popcountll(P[i]);
+        }
+        for (int color = 1; remaining > 0; color++) {
+            for (int i = 0; i < w.wordCount; i++) U[i] = Q[i];
+            for (int word = 0; word < w.wordCount; word++) {
+                while (U[word]) {
+                    int v = (word << 6) + __builtin_ctzll(U[word]);
+                    clearBit(U, v);
+                    clearBit(Q, v);
+                    remaining--;
+                    const uint64_t* adjacent = row(w, v);
+                    for (int i = word; i < w.wordCount; i++) U[i] &= ~adjacent[i];
+                    if (color >= minColor) {
+                        level.branches.push_back(v);
+                        level.colors.push_back(color);
+                    }
+                }
+            }
+        }
+    }
+
+    void expand(Worker& w, int depth) {
+        Level& level = w.levels[depth];
+        int cliqueSize = depth + 1;
+        PROFILE_NODE(cliqueSize);
+        colorCandidates(w, level, bestSize.load(std::memory_order_relaxed) - cliqueSize + 1);
+
+        uint64_t* P = level.candidates.data();
+        uint64_t* nextP = w.levels[depth + 1].candidates.data();
+        for (int b = static_cast<int>(level.branches.size()) - 1; b >= 0; b--) {
+            if (cliqueSize + level.colors[b] <= bestSize.load(std::memory_order_relaxed)) return;
+            int v = level.branches[b];
+            const uint64_t* adjacent = row(w, v);
+            bool any = false;
+            for (int i = 0; i < w.wordCount; i++) {
+                nextP[i] = P[i] & adjacent[i];
+                any |= nextP[i] != 0;
+            }
+            w.chosen.push_back(v);
+            if (any) {
+                expand(w, depth + 1);
+            } else {
+                offer(w, cliqueSize + 1);
+            }
+            w.chosen.pop_back();
+            clearBit(P, v);
+        }
+    }
+
+    // Makes root + chosen the incumbent if it is still larger.
+    void offer(const Worker& w, int size) {
+        if (size <= bestSize.load(std::memory_order_relaxed)) return;
+        std::lock_guard<std::mutex> guard(bestLock);
+        if (size <= bestSize.load(std::memory_order_relaxed)) return;
+        bestMembers.assign(1, w.root);
+        for (int local : w.chosen) bestMembers.push_back(w.localVertices[local]);
+        bestSize.store(size, std::memory_order_relaxed);
+    }
+
+    const CSRGraph& graph;
+    const std::vector<int>& ordering;
+    int workers;
+    const std::vector<int>* givenCoreNumbers;
+    std::vector<int> coreNumber;
+    std::vector<int> position;
+
+    std::atomic<int> bestSize;
+    std::mutex bestLock;
+    std::vector<int> bestMembers;
+};
+
+#endif
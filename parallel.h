@@ -0,0 +1,84 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+
+inline int hardwareThreads() {
+    unsigned count = std::thread::hardware_concurrency();
+    return count == 0 ? 1 : static_cast<int>(count);
+}
+
+// Splits [begin, end) into one contiguous block per thread and calls
+// body(blockBegin, blockEnd, threadIndex) on each. Runs inline for one thread.
+template <class Body>
+void parallelFor(int64_t begin, int64_t end, int threads, Body body) {
+    int64_t total = end - begin;
+    if (total <= 0) return;
+    threads = static_cast<int>(std::max<int64_t>(1, std::min<int64_t>(threads, total)));
+    if (threads == 1) {
+        body(begin, end, 0);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (int t = 1; t < threads; t++) {
+        int64_t lo = begin + total * t / threads;
+        int64_t hi = begin + total * (t + 1) / threads;
+        workers.emplace_back([=, &body]() { body(lo, hi, t); });
+    }
+    body(begin, begin + total / threads, 0);
+    for (auto& worker : workers) worker.join();
+}
+
+// Like parallelFor, but threads claim grain-sized slices from a shared
+// counter, which evens out ranges whose items differ widely in cost.
+template <class Body>
+void parallelForDynamic(int64_t begin, int64_t end, int64_t grain, int threads, Body body) {
+    if (end <= begin) return;
+    grain = std::max<int64_t>(1, grain);
+    std::atomic<int64_t> next(begin);
+    int64_t slices = (end - begin + grain - 1) / grain;
+    parallelFor(0, std::min<int64_t>(threads, slices), threads, [&](int64_t, int64_t, int thread) {
+        for (;;) {
+            int64_t lo = next.fetch_add(grain, std::memory_order_relaxed);
+            if (lo >= end) break;
+            body(lo, std::min(end, lo + grain), thread);
+        }
+    });
+}
+
+// Replaces values[0..n) by its exclusive prefix sum and returns the total.
+template <class T>
+T parallelExclusiveScan(T* values, int64_t n, int threads) {
+    if (n <= 0) return T(0);
+    int blocks = static_cast<int>(std::max<int64_t>(1, std::min<int64_t>(threads, n / 65536)));
+    std::vector<T> blockTotals(blocks + 1, T(0));
+
+    parallelFor(0, blocks, blocks, [&](int64_t, int64_t, int b) {
+        int64_t lo = n * b / blocks;
+        int64_t hi = n * (b + 1) / blocks;
+        T sum = T(0);
+        for (int64_t i = lo; i < hi; i++) sum += values[i];
+        blockTotals[b + 1] = sum;
+    });
+    for (int b = 0; b < blocks; b++) blockTotals[b + 1] += blockTotals[b];
+
+    parallelFor(0, blocks, blocks, [&](int64_t, int64_t, int b) {
+        int64_t lo = n * b / blocks;
+        int64_t hi = n * (b + 1) / blocks;
+        T running = blockTotals[b];
+        for (int64_t i = lo; i < hi; i++) {
+            T value = values[i];
+            values[i] = running;
+            running += value;
+        }
+    });
+    return blockTotals[blocks];
+}
+
+#endif
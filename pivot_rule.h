@@ -0,0 +1,104 @@
+#ifndef PIVOT_RULE_H
+#define PIVOT_RULE_H
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "csr_graph.h"
+#include "profiling.h"
+
+// How a Bron-Kerbosch frame picks its pivot u; candidates adjacent to u are
+// not branched on. The rules trade search-tree size for the cost of a pick:
+//   PIVOT_TOMITA      u in P ∪ X with the most neighbors in P, the rule
+//                     that bounds the tree; needs |N(u) ∩ P| for every u
+//   PIVOT_MAX_DEGREE  u in P ∪ X of largest degree in the graph searched,
+//                     one lookup per vertex
+//   PIVOT_FIRST       the first candidate, at no cost
+enum PivotRule { PIVOT_TOMITA, PIVOT_MAX_DEGREE, PIVOT_FIRST };
+
+inline bool parsePivotRule(const std::string& name, PivotRule& rule) {
+    if (name == "tomita") {
+        rule = PIVOT_TOMITA;
+    } else if (name == "maxdeg") {
+        rule = PIVOT_MAX_DEGREE;
+    } else if (name == "first") {
+        rule = PIVOT_FIRST;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+inline const char* pivotRuleName(PivotRule rule) {
+    return rule == PIVOT_TOMITA ? "tomita" : rule == PIVOT_MAX_DEGREE ? "maxdeg" : "first";
+}
+
+// |N(u) ∩ P| for every vertex u of a graph, counted in one pass over the
+// adjacency of P rather than one intersection per u. Each count carries the
+// number of its pass in the high half, so a pass never has to clear what
+// the previous one left. One instance is reused per worker.
+class PivotScores {
+public:
+    PivotScores() : pass(0) {}
+
+    // Sizes the counts for a graph of vertexCount vertices.
+    void reset(int vertexCount) {
+        counts.assign(vertexCount, 0);
+        pass = 0;
+    }
+
+    void countNeighborsIn(const CSRGraph& graph, const int* P, int pCount) {
+        if (++pass == 0) {
+            std::fill(counts.begin(), counts.end(), 0);
+            pass = 1;
+        }
+        uint64_t tag = uint64_t(pass) << 32;
+        for (int i = 0; i < pCount; i++) {
+            NeighborRange adjacent = graph.neighbors(P[i]);
+            PROFILE_COUNT(PIVOT_WORK, adjacent.size());
+            for (int w : adjacent) {
+                uint64_t& count = counts[w];
+                count = (count & ~uint64_t(0xffffffff)) == tag ? count + 1 : tag + 1;
+            }
+        }
+    }
+
+    // |N(u) ∩ P| for the P of the last pass.
+    int operator[](int u) const {
+        uint64_t count = counts[u];
+        return (count >> 32) == pass ? static_cast<int>(count & 0xffffffff) : 0;
+    }
+
+private:
+    std::vector<uint64_t> counts;
+    uint32_t pass;
+};
+
+// The pivot under rule of a search frame over graph with candidates P,
+// which must not be empty, and excluded vertices X. Ties go to the vertex
+// met first, scanning P before X.
+inline int pickPivot(PivotRule rule, const CSRGraph& graph, PivotScores& scores, const int* P, int pCount,
+                     const int* X, int xCount) {
+    if (rule == PIVOT_FIRST) return P[0];
+    if (rule == PIVOT_TOMITA) scores.countNeighborsIn(graph, P, pCount);
+    int pivot = P[0];
+    int bestScore = -1;
+    for (int part = 0; part < 2; part++) {
+        const int* vertices = part == 0 ? P : X;
+        int count = part == 0 ? pCount : xCount;
+        for (int i = 0; i < count; i++) {
+            int u = vertices[i];
+            PROFILE_COUNT(PIVOT_CANDIDATES, 1);
+            int score = rule == PIVOT_TOMITA ? scores[u] : graph.degree(u);
+            if (score > bestScore) {
+                bestScore = score;
+                pivot = u;
+            }
+        }
+    }
+    return pivot;
+}
+
+#endif
@@ -0,0 +1,183 @@
+#ifndef PROFILING_H
+#define PROFILING_H
+
+// Hot-path counters and phase timers, compiled in only with -DCLIQUE_PROFILE.
+// Without it every PROFILE_* macro expands to nothing, so the arguments are
+// not evaluated and the build is the same as if the calls were not there.
+//
+//   PROFILE_COUNT(counter, n)  add n to one of the profiling::Counter values
+//   PROFILE_NODE(depth)        one search node at recursion depth (clique size)
+//   PROFILE_PHASE(phase)       time the rest of the scope as a Phase
+//   PROFILE_ROOT()             time the rest of the scope as one outer vertex
+//   PROFILE_REPORT()           write the JSON report
+//
+// Counters are per thread and summed for the report, which goes to the file
+// named by CLIQUE_PROFILE_OUTPUT, or to stderr.
+
+#ifdef CLIQUE_PROFILE
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+namespace profiling {
+
+enum Counter {
+    INTERSECTIONS,        // sorted-set intersections
+    INTERSECT_INPUT,      // elements on both sides of them
+    INTERSECT_OUTPUT,     // elements they found in common
+    PIVOT_CANDIDATES,     // P and X vertices scored during pivot selection
+    PIVOT_WORK,           // neighbors or words scanned to score them
+    KERNEL_BUILDS,        // subproblems loaded into the bitset kernel
+    KERNEL_FALLBACKS,     // subproblems too large for it
+    CLIQUES_RECORDED,     // histogram updates
+    COUNTER_COUNT
+};
+
+enum Phase { LOAD, ORDERING, SEARCH, PHASE_COUNT };
+
+static const char* const counterNames[COUNTER_COUNT] = {
+    "intersections", "intersect_input", "intersect_output", "pivot_candidates",
+    "pivot_work", "kernel_builds", "kernel_fallbacks", "cliques_recorded"};
+static const char* const phaseNames[PHASE_COUNT] = {"load", "ordering", "search"};
+
+// Outer-vertex times go in power-of-two buckets: bucket b counts roots that
+// took [2^b, 2^(b+1)) microseconds, and bucket 0 everything under 2.
+static const int ROOT_BUCKETS = 32;
+
+struct ThreadCounters {
+    uint64_t counters[COUNTER_COUNT] = {};
+    std::vector<uint64_t> nodesAtDepth;
+    uint64_t roots = 0;
+    uint64_t rootNanos = 0;
+    uint64_t slowestRootNanos = 0;
+    uint64_t rootBuckets[ROOT_BUCKETS] = {};
+
+    void node(int depth) {
+        if (depth >= static_cast<int>(nodesAtDepth.size())) nodesAtDepth.resize(depth + 1, 0);
+        nodesAtDepth[depth]++;
+    }
+
+    void root(uint64_t nanos) {
+        roots++;
+        rootNanos += nanos;
+        if (nanos > slowestRootNanos) slowestRootNanos = nanos;
+        int bucket = 0;
+        for (uint64_t micros = nanos / 1000; micros > 1 && bucket < ROOT_BUCKETS - 1; micros >>= 1) bucket++;
+        rootBuckets[bucket]++;
+    }
+};
+
+// Owns every thread's counters, so they outlive pool threads that exit
+// before the report is written.
+struct Registry {
+    std::mutex lock;
+    std::vector<std::unique_ptr<ThreadCounters>> threads;
+    std::atomic<uint64_t> phaseNanos[PHASE_COUNT] = {};
+};
+
+inline Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+inline ThreadCounters& local() {
+    thread_local ThreadCounters* mine = [] {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> guard(r.lock);
+        r.threads.emplace_back(new ThreadCounters());
+        return r.threads.back().get();
+    }();
+    return *mine;
+}
+
+inline uint64_t elapsedNanos(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+class PhaseTimer {
+public:
+    explicit PhaseTimer(Phase p) : phase(p), start(std::chrono::steady_clock::now()) {}
+    ~PhaseTimer() { registry().phaseNanos[phase] += elapsedNanos(start); }
+
+private:
+    Phase phase;
+    std::chrono::steady_clock::time_point start;
+};
+
+class RootTimer {
+public:
+    RootTimer() : start(std::chrono::steady_clock::now()) {}
+    ~RootTimer() { local().root(elapsedNanos(start)); }
+
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+inline void writeReport() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    ThreadCounters sum;
+    for (const auto& t : r.threads) {
+        for (int c = 0; c < COUNTER_COUNT; c++) sum.counters[c] += t->counters[c];
+        if (t->nodesAtDepth.size() > sum.nodesAtDepth.size()) sum.nodesAtDepth.resize(t->nodesAtDepth.size(), 0);
+        for (size_t d = 0; d < t->nodesAtDepth.size(); d++) sum.nodesAtDepth[d] += t->nodesAtDepth[d];
+        sum.roots += t->roots;
+        sum.rootNanos += t->rootNanos;
+        if (t->slowestRootNanos > sum.slowestRootNanos) sum.slowestRootNanos = t->slowestRootNanos;
+        for (int b = 0; b < ROOT_BUCKETS; b++) sum.rootBuckets[b] += t->rootBuckets[b];
+    }
+
+    const char* path = std::getenv("CLIQUE_PROFILE_OUTPUT");
+    FILE* out = path ? std::fopen(path, "w") : nullptr;
+    if (!out) out = stderr;
+    std::fprintf(out, "{\"phases_ms\": {");
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        std::fprintf(out, "%s\"%s\": %.3f", p ? ", " : "", phaseNames[p], r.phaseNanos[p].load() / 1e6);
+    }
+    std::fprintf(out, "}, \"counters\": {");
+    for (int c = 0; c < COUNTER_COUNT; c++) {
+        std::fprintf(out, "%s\"%s\": %llu", c ? ", " : "", counterNames[c],
+                     static_cast<unsigned long long>(sum.counters[c]));
+    }
+    std::fprintf(out, "}, \"nodes_per_depth\": [");
+    for (size_t d = 0; d < sum.nodesAtDepth.size(); d++) {
+        std::fprintf(out, "%s%llu", d ? ", " : "", static_cast<unsigned long long>(sum.nodesAtDepth[d]));
+    }
+    int lastBucket = ROOT_BUCKETS - 1;
+    while (lastBucket > 0 && sum.rootBuckets[lastBucket] == 0) lastBucket--;
+    std::fprintf(out, "], \"roots\": {\"count\": %llu, \"total_ms\": %.3f, \"slowest_ms\": %.3f, \"log2_us_histogram\": [",
+                 static_cast<unsigned long long>(sum.roots), sum.rootNanos / 1e6, sum.slowestRootNanos / 1e6);
+    for (int b = 0; b <= lastBucket; b++) {
+        std::fprintf(out, "%s%llu", b ? ", " : "", static_cast<unsigned long long>(sum.rootBuckets[b]));
+    }
+    std::fprintf(out, "]}}\n");
+    if (out != stderr) std::fclose(out);
+}
+
+}  // namespace profiling
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_COUNT(counter, n) (profiling::local().counters[profiling::counter] += (n))
+#define PROFILE_NODE(depth) profiling::local().node(depth)
+#define PROFILE_PHASE(phase) profiling::PhaseTimer PROFILE_CONCAT(profilePhase, __LINE__)(profiling::phase)
+#define PROFILE_ROOT() profiling::RootTimer PROFILE_CONCAT(profileRoot, __LINE__)
+#define PROFILE_REPORT() profiling::writeReport()
+
+#else
+
+#define PROFILE_COUNT(counter, n) ((void)0)
+#define PROFILE_NODE(depth) ((void)0)
+#define PROFILE_PHASE(phase) ((void)0)
+#define PROFILE_ROOT() ((void)0)
+#define PROFILE_REPORT() ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef RUN_OPTIONS_H
+#define RUN_OPTIONS_H
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+#include "parallel.h"
+#include "clique_sink.h"
+#include "pivot_rule.h"
+
+// Command-line settings shared by the clique finders. The first non-option
+// argument names the input, which may be a text edge list or a snapshot.
+struct RunOptions {
+    std::string inputFile = "Email-Enron.txt";
+    std::string snapshotOutput;
+    int threads = 0;  // 0 = not given
+    std::string engine = "bk";
+    std::string outputFile;  // "-" = stdout
+    CliqueSink::Format outputFormat = CliqueSink::TEXT;
+    bool maxClique = false;  // find one maximum clique instead of enumerating
+    int minSize = 1;         // smallest clique size reported
+    int topCount = 0;        // > 0: only the largest topCount cliques
+    bool relabel = false;    // renumber vertices by degeneracy rank first
+    PivotRule pivotRule = PIVOT_TOMITA;
+    std::string checkpointFile;    // save enumeration progress here
+    int checkpointInterval = 300;  // seconds between checkpoints
+    bool resume = false;           // continue from checkpointFile if it exists
+
+    // Loading is parallel by default; enumeration only when asked.
+    int loadThreads() const { return threads > 0 ? threads : hardwareThreads(); }
+    int searchThreads() const { return threads > 0 ? threads : 1; }
+};
+
+inline void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [input-file] [options]\n"
+              << "  input-file              edge list or graph snapshot (default Email-Enron.txt)\n"
+              << "  --save-snapshot PATH    write the loaded graph as a binary snapshot\n"
+              << "  --threads N             worker threads for loading and enumeration\n"
+              << "  --engine NAME           enumeration engine: bk (default), or kose or iterative (chiba only)\n"
+              << "  --output FILE           write every maximal clique to FILE (- for stdout)\n"
+              << "  --output-format FORMAT  text (default, one clique per line) or binary\n"
+              << "  --min-size K            only report cliques of at least K vertices\n"
+              << "  --top K                 only report the K largest maximal cliques (bk engines)\n"
+              << "  --max-clique            only find a maximum clique, by branch and bound\n"
+              << "  --relabel               renumber vertices by degeneracy rank (chiba, els-algo)\n"
+              << "  --pivot RULE            pivot rule: tomita (default), maxdeg or first\n"
+              << "  --checkpoint FILE       save counting progress to FILE as the run goes (chiba, bk)\n"
+              << "  --checkpoint-interval S seconds between checkpoints (default 300)\n"
+              << "  --resume                continue from the --checkpoint file, if there is one\n";
+}
+
+// Fills options from argv. Prints usage and returns false on an unknown or
+// incomplete argument, or when help is requested.
+inline bool parseRunOptions(int argc, char* argv[], RunOptions& options) {
+    bool haveInput = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto takeValue = [&](std::string& value) {
+            if (i + 1 >= argc) return false;
+            value = argv[++i];
+            return true;
+        };
+        auto takeCount = [&](int& value, int minimum) {
+            std::string text;
+            if (!takeValue(text)) return false;
+            char* end = nullptr;
+            long parsed = strtol(text.c_str(), &end, 10);
+            if (text.empty() || *end != '\0' || parsed < minimum || parsed > 1 << 20) return false;
+            value = static_cast<int>(parsed);
+            return true;
+        };
+
+        bool ok = true;
+        if (arg == "--save-snapshot") {
+            ok = takeValue(options.snapshotOutput);
+        } else if (arg == "--threads") {
+            ok = takeCount(options.threads, 1);
+        } else if (arg == "--engine") {
+            ok = takeValue(options.engine);
+        } else if (arg == "--min-size") {
+            ok = takeCount(options.minSize, 1);
+        } else if (arg == "--top") {
+            ok = takeCount(options.topCount, 1);
+        } else if (arg == "--max-clique") {
+            options.maxClique = true;
+        } else if (arg == "--relabel") {
+            options.relabel = true;
+        } else if (arg == "--pivot") {
+            std::string name;
+            ok = takeValue(name) && parsePivotRule(name, options.pivotRule);
+        } else if (arg == "--checkpoint") {
+            ok = takeValue(options.checkpointFile);
+        } else if (arg == "--checkpoint-interval") {
+            ok = takeCount(options.checkpointInterval, 1);
+        } else if (arg == "--resume") {
+            options.resume = true;
+        } else if (arg == "--output") {
+            ok = takeValue(options.outputFile);
+        } else if (arg == "--output-format") {
+            std::string name;
+            ok = takeValue(name) && CliqueSink::parseFormat(name, options.outputFormat);
+        } else if (!arg.empty() && arg[0] == '-') {
+            ok = false;
+        } else if (!haveInput) {
+            options.inputFile = arg;
+            haveInput = true;
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            if (arg != "-h" && arg != "--help") std::cerr << "Bad argument: " << arg << std::endl;
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+    if (options.resume && options.checkpointFile.empty()) {
+        std::cerr << "--resume needs --checkpoint FILE" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Opens sink for options.outputFile, if one was given. Cliques written to
+// stdout take it over, so the caller's summary is moved to stderr.
+inline bool openCliqueOutput(const RunOptions& options, CliqueSink& sink) {
+    if (options.outputFile.empty()) return true;
+    std::string error;
+    if (!sink.open(options.outputFile, options.outputFormat, options.searchThreads(), error)) {
+        std::cerr << "Error: " << error << std::endl;
+        return false;
+    }
+    if (options.outputFile == "-") std::cout.rdbuf(std::cerr.rdbuf());
+    return true;
+}
+
+inline bool closeCliqueOutput(const RunOptions& options, CliqueSink& sink) {
+    if (sink.close()) return true;
+    std::cerr << "Error: failed writing " << options.outputFile << std::endl;
+    return false;
+}
+
+#endif
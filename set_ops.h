@@ -0,0 +1,313 @@
+#ifndef SET_OPS_H
+#define SET_OPS_H
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <chrono>
+#include <immintrin.h>
+
+#include "profiling.h"
+
+// Intersection of two ascending, duplicate-free int arrays. Every kernel
+// writes the common elements to out in ascending order and returns how many
+// there are; with out == nullptr it only counts.
+//
+// intersectSorted() picks galloping search when one side is much shorter and
+// otherwise the fastest block kernel the CPU supports. Both the kernel and
+// the size ratio where galloping takes over are settled once, at first use,
+// by timing the candidates on this host: a wider ISA is not always faster.
+//
+// The SIMD kernels compare a block of each input against every rotation of
+// the other block, then advance past whichever block ends lower.
+
+namespace setops {
+
+typedef size_t (*IntersectFn)(const int* a, size_t na, const int* b, size_t nb, int* out);
+
+inline size_t emitMatches(const int* block, unsigned mask, int* out) {
+    size_t count = __builtin_popcount(mask);
+    if (out) {
+        while (mask) {
+            *out++ = block[__builtin_ctz(mask)];
+            mask &= mask - 1;
+        }
+    }
+    return count;
+}
+
+inline size_t intersectMerge(const int* a, size_t na, const int* b, size_t nb, int* out) {
+    size_t i = 0, j = 0, k = 0;
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            i++;
+        } else if (b[j] < a[i]) {
+            j++;
+        } else {
+            if (out) out[k] = a[i];
+            k++;
+            i++;
+            j++;
+        }
+    }
+    return k;
+}
+
+// For each element of the short side, doubles a step through the long side
+// until it passes the element, then binary searches the last step.
+inline size_t intersectGalloping(const int* small, size_t ns, const int* large, size_t nl, int* out) {
+    size_t k = 0, low = 0;
+    for (size_t i = 0; i < ns && low < nl; i++) {
+        int value = small[i];
+        size_t step = 1, high = low;
+        while (high < nl && large[high] < value) {
+            low = high + 1;
+            high += step;
+            step <<= 1;
+        }
+        if (high > nl) high = nl;
+        low = std::lower_bound(large + low, large + high, value) - large;
+        if (low < nl && large[low] == value) {
+            if (out) out[k] = value;
+            k++;
+            low++;
+        }
+    }
+    return k;
+}
+
+__attribute__((target("sse4.2")))
+inline size_t intersectSSE(const int* a, size_t na, const int* b, size_t nb, int* out) {
+    size_t i = 0, j = 0, k = 0;
+    while (i + 4 <= na && j + 4 <= nb) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+        __m128i hits = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi32(va, vb), _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+            _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))),
+                         _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)))));
+        unsigned mask = _mm_movemask_ps(_mm_castsi128_ps(hits));
+        k += emitMatches(a + i, mask, out ? out + k : nullptr);
+        int lastA = a[i + 3], lastB = b[j + 3];
+        if (lastA <= lastB) i += 4;
+        if (lastB <= lastA) j += 4;
+    }
+    return k + intersectMerge(a + i, na - i, b + j, nb - j, out ? out + k : nullptr);
+}
+
+__attribute__((target("avx2")))
+inline size_t intersectAVX2(const int* a, size_t na, const int* b, size_t nb, int* out) {
+    size_t i = 0, j = 0, k = 0;
+    while (i + 8 <= na && j + 8 <= nb) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+        // Rotations within each 128-bit lane, then the same with lanes swapped,
+        // cover all eight alignments without a dependent chain of permutes.
+        __m256i vs = _mm256_permute2x128_si256(vb, vb, 1);
+        __m256i hits = _mm256_or_si256(
+            _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi32(va, vb), _mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+                _mm256_or_si256(_mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))),
+                                _mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))))),
+            _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi32(va, vs), _mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vs, _MM_SHUFFLE(0, 3, 2, 1)))),
+                _mm256_or_si256(_mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vs, _MM_SHUFFLE(1, 0, 3, 2))),
+                                _mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vs, _MM_SHUFFLE(2, 1, 0, 3))))));
+        unsigned mask = _mm256_movemask_ps(_mm256_castsi256_ps(hits));
+        k += emitMatches(a + i, mask, out ? out + k : nullptr);
+        int lastA = a[i + 7], lastB = b[j + 7];
+        if (lastA <= lastB) i += 8;
+        if (lastB <= lastA) j += 8;
+    }
+    return k + intersectSSE(a + i, na - i, b + j, nb - j, out ? out + k : nullptr);
+}
+
+// GCC 12 flags the deliberately undefined source operand inside its own
+// AVX-512 intrinsics.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+namespace detail {
+
+// Matches of va against the four in-lane rotations of vb.
+__attribute__((target("avx512f")))
+inline __mmask16 matchLaneRotations(__m512i va, __m512i vb) {
+    return _mm512_cmpeq_epi32_mask(va, vb) |
+           _mm512_cmpeq_epi32_mask(va, _mm512_shuffle_epi32(vb, _MM_PERM_ADCB)) |
+           _mm512_cmpeq_epi32_mask(va, _mm512_shuffle_epi32(vb, _MM_PERM_BADC)) |
+           _mm512_cmpeq_epi32_mask(va, _mm512_shuffle_epi32(vb, _MM_PERM_CBAD));
+}
+
+}
+
+__attribute__((target("avx512f")))
+inline size_t intersectAVX512(const int* a, size_t na, const int* b, size_t nb, int* out) {
+    size_t i = 0, j = 0, k = 0;
+    while (i + 16 <= na && j + 16 <= nb) {
+        __m512i va = _mm512_loadu_si512(a + i);
+        __m512i vb = _mm512_loadu_si512(b + j);
+        // Four lane rotations times four in-lane rotations: all sixteen alignments.
+        __mmask16 mask = detail::matchLaneRotations(va, vb) |
+                         detail::matchLaneRotations(va, _mm512_shuffle_i32x4(vb, vb, _MM_SHUFFLE(0, 3, 2, 1))) |
+                         detail::matchLaneRotations(va, _mm512_shuffle_i32x4(vb, vb, _MM_SHUFFLE(1, 0, 3, 2))) |
+                         detail::matchLaneRotations(va, _mm512_shuffle_i32x4(vb, vb, _MM_SHUFFLE(2, 1, 0, 3)));
+        if (out) _mm512_mask_compressstoreu_epi32(out + k, mask, va);
+        k += __builtin_popcount(mask);
+        int lastA = a[i + 15], lastB = b[j + 15];
+        if (lastA <= lastB) i += 16;
+        if (lastB <= lastA) j += 16;
+    }
+    return k + intersectAVX2(a + i, na - i, b + j, nb - j, out ? out + k : nullptr);
+}
+
+#pragma GCC diagnostic pop
+
+struct KernelChoice {
+    IntersectFn block;
+    const char* name;
+    size_t gallopRatio;  // size ratio from which galloping beats block
+};
+
+// Best of a few trials of repeats calls to run, in nanoseconds per call.
+template <class Run>
+inline double bestNanosPerCall(Run&& run, int repeats) {
+    double best = 0;
+    for (int trial = 0; trial < 3; trial++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; r++) run();
+        double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / repeats;
+        if (trial == 0 || nanos < best) best = nanos;
+    }
+    return best;
+}
+
+// Smallest power-of-two size ratio, up to MAX_GALLOP_RATIO, from which
+// galloping beats block here at that ratio and the next, timed with a short
+// side of 32 elements of which half are in the long side.
+const size_t MAX_GALLOP_RATIO = 512;
+
+inline size_t calibrateGallopRatio(IntersectFn block) {
+    const size_t shortSize = 32;
+    std::vector<int> large(shortSize * MAX_GALLOP_RATIO);
+    for (size_t i = 0; i < large.size(); i++) large[i] = static_cast<int>(3 * i + (i * 2654435761u >> 7) % 3);
+    std::vector<int> small(shortSize), out(shortSize);
+    volatile size_t sink = 0;
+    size_t crossover = 0;
+    for (size_t ratio = 2; ratio < MAX_GALLOP_RATIO; ratio *= 2) {
+        size_t longSize = shortSize * ratio;
+        for (size_t i = 0; i < shortSize; i++) {
+            int v = large[i * longSize / shortSize];
+            small[i] = i % 2 ? v : v + 1;
+        }
+        int repeats = static_cast<int>(std::max<size_t>(8, 65536 / longSize));
+        double gallop = bestNanosPerCall([&] { sink = sink + intersectGalloping(small.data(), shortSize, large.data(), longSize, out.data()); }, repeats);
+        double linear = bestNanosPerCall([&] { sink = sink + block(small.data(), shortSize, large.data(), longSize, out.data()); }, repeats);
+        if (gallop >= linear) {
+            crossover = 0;
+        } else if (crossover == 0) {
+            crossover = ratio;
+        } else {
+            return crossover;
+        }
+    }
+    return crossover ? crossover : MAX_GALLOP_RATIO;
+}
+
+// Time of block over the shapes it handles below the galloping ratio, from
+// equal sizes to a long side eight times the short one, with about a third
+// of the short side in common. Each shape counts per input element, so the
+// large ones do not drown out the small.
+inline double timeBlockKernel(IntersectFn block) {
+    static const size_t shapes[][2] = {{64, 64}, {64, 512}, {1024, 1024}, {1024, 4096}};
+    double total = 0;
+    volatile size_t sink = 0;
+    for (const auto& shape : shapes) {
+        size_t shortSize = shape[0], longSize = shape[1];
+        std::vector<int> large(longSize), small(shortSize), out(shortSize);
+        for (size_t i = 0; i < longSize; i++) large[i] = static_cast<int>(3 * i + (i * 2654435761u >> 7) % 3);
+        size_t step = 3 * longSize / shortSize;
+        for (size_t i = 0; i < shortSize; i++) small[i] = static_cast<int>(step * i + (i * 2654435761u >> 9) % 3);
+        int repeats = static_cast<int>(std::max<size_t>(8, 32768 / (shortSize + longSize)));
+        total += bestNanosPerCall([&] { sink = sink + block(small.data(), shortSize, large.data(), longSize, out.data()); }, repeats) /
+                 (shortSize + longSize);
+    }
+    return total;
+}
+
+// The candidates run narrowest first. Each round times all of them back to
+// back, and two are compared by the median over the rounds of their time
+// ratio, so that the host speeding up or slowing down between rounds does
+// not decide. A wider kernel replaces a narrower one only when it is
+// clearly faster: on some CPUs AVX-512 runs no faster than AVX2, or slower.
+inline KernelChoice detectKernel() {
+    __builtin_cpu_init();
+    const KernelChoice candidates[] = {
+        {intersectMerge, "scalar", 0},
+        {intersectSSE, "sse4.2", 0},
+        {intersectAVX2, "avx2", 0},
+        {intersectAVX512, "avx512", 0},
+    };
+    const bool supported[] = {
+        true,
+        (bool)__builtin_cpu_supports("sse4.2"),
+        (bool)__builtin_cpu_supports("avx2"),
+        (bool)__builtin_cpu_supports("avx512f"),
+    };
+    const int rounds = 9;
+    double nanos[rounds][4] = {};
+    for (int round = 0; round < rounds; round++) {
+        for (int i = 0; i < 4; i++) {
+            if (supported[i]) nanos[round][i] = timeBlockKernel(candidates[i].block);
+        }
+    }
+    int chosen = 0;
+    for (int i = 1; i < 4; i++) {
+        if (!supported[i]) continue;
+        double ratios[rounds];
+        for (int round = 0; round < rounds; round++) ratios[round] = nanos[round][i] / nanos[round][chosen];
+        std::nth_element(ratios, ratios + rounds / 2, ratios + rounds);
+        if (ratios[rounds / 2] < 0.95) chosen = i;
+    }
+    KernelChoice choice = candidates[chosen];
+    choice.gallopRatio = calibrateGallopRatio(choice.block);
+    return choice;
+}
+
+inline const KernelChoice& activeKernel() {
+    static const KernelChoice choice = detectKernel();
+    return choice;
+}
+
+}
+
+// Name of the block kernel chosen for this CPU.
+inline const char* intersectKernelName() { return setops::activeKernel().name; }
+
+// Writes a ∩ b to out, which needs room for min(na, nb) elements, and
+// returns its size. Pass out == nullptr to only count.
+inline size_t intersectSorted(const int* a, size_t na, const int* b, size_t nb, int* out) {
+    PROFILE_COUNT(INTERSECTIONS, 1);
+    PROFILE_COUNT(INTERSECT_INPUT, na + nb);
+    if (na > nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    if (na == 0) return 0;
+    const setops::KernelChoice& kernel = setops::activeKernel();
+    size_t found = nb / na >= kernel.gallopRatio ? setops::intersectGalloping(a, na, b, nb, out)
+                                                 : kernel.block(a, na, b, nb, out);
+    PROFILE_COUNT(INTERSECT_OUTPUT, found);
+    return found;
+}
+
+inline size_t intersectionSize(const int* a, size_t na, const int* b, size_t nb) {
+    return intersectSorted(a, na, b, nb, nullptr);
+}
+
+// Replaces out with a ∩ b.
+inline void intersectInto(const int* a, size_t na, const int* b, size_t nb, std::vector<int>& out) {
+    out.resize(std::min(na, nb));
+    out.resize(intersectSorted(a, na, b, nb, out.data()));
+}
+
+#endif
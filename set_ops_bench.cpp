@@ -0,0 +1,97 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+
+#include "set_ops.h"
+
+using namespace std;
+using namespace std::chrono;
+
+// Times each intersection kernel on random sorted arrays over a range of
+// sizes and size ratios. Usage: set_ops_bench [repetitions]
+
+struct Kernel {
+    string name;
+    setops::IntersectFn function;
+    bool supported;
+};
+
+static vector<int> randomSortedSet(mt19937& rng, size_t size, int universe) {
+    uniform_int_distribution<int> pick(0, universe - 1);
+    vector<int> values;
+    while (values.size() < size) {
+        values.push_back(pick(rng));
+        if (values.size() == size) {
+            sort(values.begin(), values.end());
+            values.erase(unique(values.begin(), values.end()), values.end());
+        }
+    }
+    return values;
+}
+
+int main(int argc, char* argv[]) {
+    int repetitions = argc > 1 ? atoi(argv[1]) : 2000;
+    if (repetitions < 1) repetitions = 1;
+
+    __builtin_cpu_init();
+    vector<Kernel> kernels = {
+        {"merge", setops::intersectMerge, true},
+        {"gallop", setops::intersectGalloping, true},
+        {"sse4.2", setops::intersectSSE, (bool)__builtin_cpu_supports("sse4.2")},
+        {"avx2", setops::intersectAVX2, (bool)__builtin_cpu_supports("avx2")},
+        {"avx512", setops::intersectAVX512, (bool)__builtin_cpu_supports("avx512f")},
+    };
+
+    cout << "Dispatched block kernel: " << intersectKernelName() << ", galloping from size ratio "
+         << setops::activeKernel().gallopRatio << endl;
+    cout << setw(8) << "small" << setw(8) << "large" << setw(10) << "common";
+    for (const Kernel& kernel : kernels) cout << setw(10) << kernel.name;
+    cout << setw(10) << "dispatch" << "   (ns per intersection)" << endl;
+
+    mt19937 rng(12345);
+    const size_t smallSizes[] = {16, 64, 256, 1024};
+    const size_t ratios[] = {1, 4, 32, 256};
+    for (size_t smallSize : smallSizes) {
+        for (size_t ratio : ratios) {
+            size_t largeSize = smallSize * ratio;
+            int universe = static_cast<int>(largeSize * 4);
+            vector<int> small = randomSortedSet(rng, smallSize, universe);
+            vector<int> large = randomSortedSet(rng, largeSize, universe);
+            vector<int> out(small.size());
+
+            size_t expected = setops::intersectMerge(small.data(), small.size(), large.data(), large.size(), out.data());
+            vector<int> reference(out.begin(), out.begin() + expected);
+            cout << setw(8) << small.size() << setw(8) << large.size() << setw(10) << expected;
+
+            auto timeKernel = [&](setops::IntersectFn function) {
+                size_t found = 0;
+                auto start = high_resolution_clock::now();
+                for (int r = 0; r < repetitions; r++) {
+                    found += function(small.data(), small.size(), large.data(), large.size(), out.data());
+                }
+                auto elapsed = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+                if (found != expected * repetitions || !equal(reference.begin(), reference.end(), out.begin())) {
+                    cerr << "Kernel result differs from merge on sizes " << small.size() << "/" << large.size() << endl;
+                    exit(1);
+                }
+                return static_cast<double>(elapsed) / repetitions;
+            };
+
+            cout << fixed << setprecision(0);
+            for (const Kernel& kernel : kernels) {
+                if (kernel.supported) {
+                    cout << setw(10) << timeKernel(kernel.function);
+                } else {
+                    cout << setw(10) << "-";
+                }
+            }
+            cout << setw(10) << timeKernel(intersectSorted) << endl;
+        }
+    }
+    return 0;
+}
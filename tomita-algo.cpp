@@ -1,173 +1,180 @@
 #include <iostream>
 #include <vector>
-#include <unordered_set>
-#include <map>
-#include <fstream>
-#include <sstream>
+#include <array>
+#include <algorithm>
+#include <climits>
 #include <chrono>
 
+#include "csr_graph.h"
+#include "edge_loader.h"
+#include "graph_snapshot.h"
+#include "run_options.h"
+#include "set_ops.h"
+#include "clique_sink.h"
+#include "clique_stats.h"
+#include "clique_visitor.h"
+#include "max_clique.h"
+#include "pivot_rule.h"
+#include "degeneracy.h"
+#include "profiling.h"
+
 using namespace std;
 using namespace std::chrono;
 
 class MaximalCliquesFinder {
 private:
     int vertexCount;  // Number of vertices
-    vector<unordered_set<int>> neighbors;  // Fast adjacency testing
-    int largestCliqueSize = 0;
-    int totalCliques = 0;
-    map<int, int> cliqueSizeDistribution;
+    CSRGraph graph;  // Sorted adjacency arrays
+    vector<int> fileIds;  // Input file's ID of each vertex, if a snapshot renumbered them
+    int loadThreads = 1;
+    int minCliqueSize = 1;  // Smaller cliques are pruned and not reported
+    PivotRule pivotRule = PIVOT_TOMITA;
+    int64_t searchNodes = 0;  // Recursion frames of the last enumeration
+    CliqueCounters cliqueTotals;
+
+    // Reusable sets for one recursion depth, all sorted ascending
+    struct SearchLevel {
+        vector<int> candidates;
+        vector<int> excluded;
+        vector<int> branches;
+    };
+    vector<SearchLevel> levels;
+    PivotScores pivotScores;  // Tomita counts, one per graph vertex
 
 public:
     MaximalCliquesFinder() : vertexCount(0) {}
 
-    void detectMaximalCliques() {
-        unordered_set<int> currentClique, candidateVertices, excludedVertices;
+    void setLoadThreads(int threads) { loadThreads = max(1, threads); }
+    void setMinimumCliqueSize(int size) { minCliqueSize = max(1, size); }
+    void setPivotRule(PivotRule rule) { pivotRule = rule; }
 
-        // Initialize candidate vertices (only include vertices with neighbors)
-        int vertexIndex = 0;
-while (vertexIndex < vertexCount) {
-    if (!neighbors[vertexIndex].empty())
-        candidateVertices.insert(vertexIndex);
-    vertexIndex++;
-}
-        // excludedVertices starts empty
+    // Writes each clique to output when given; otherwise only sizes are kept
+    void detectMaximalCliques(CliqueSink* output = nullptr) {
         auto startTime = high_resolution_clock::now();
-       
-        // Use single implementation for all graph sizes
-        expandClique(excludedVertices, candidateVertices, currentClique);
+
+        cliqueTotals.clear();
+        if (output) {
+            if (!fileIds.empty()) output->setIdMap(&fileIds);
+            CliqueSinkVisitor visitor(output, 0);
+            searchDegeneracyOrder(visitor);
+            visitor.addTo(cliqueTotals);
+        } else {
+            CliqueHistogramVisitor visitor;
+            searchDegeneracyOrder(visitor);
+            visitor.addTo(cliqueTotals);
+        }
        
         auto endTime = high_resolution_clock::now();
        
         // Display results
-        cout << "Number of cliques: " << totalCliques << endl;
-        cout << "Maximum clique size: " << largestCliqueSize << endl;
+        cout << "Number of cliques: " << cliqueTotals.totalCliques << endl;
+        cout << "Maximum clique size: " << cliqueTotals.largestCliqueSize << endl;
         cout << "Clique size distribution:\n";
        
-        auto timeElapsed = duration_cast<milliseconds>(endTime - startTime);
+        auto timeElapsed = duration_cast<microseconds>(endTime - startTime);
        
-        for (auto distIter = cliqueSizeDistribution.rbegin(); distIter != cliqueSizeDistribution.rend(); ++distIter) {
-            cout << "Size " << distIter->first << ": " << distIter->second << " cliques" << endl;
+        for (int size = cliqueTotals.largestCliqueSize; size >= 0; size--) {
+            if (cliqueTotals.count(size) == 0) continue;
+            cout << "Size " << size << ": " << cliqueTotals.count(size) << " cliques" << endl;
         }
        
-        cout << "Execution time: " << timeElapsed.count() << " ms" << endl;
+        cout << "Execution time: " << timeElapsed.count() / 1000.0 << " ms" << endl;
+        cout << "Search tree nodes: " << searchNodes << " (" << pivotRuleName(pivotRule) << " pivots)" << endl;
+        cout << "Intersections: " << intersectKernelName() << ", galloping from size ratio "
+             << setops::activeKernel().gallopRatio << endl;
     }
-   
-    void readGraphData(const string& inputFileName) {
-        ifstream dataFile(inputFileName);
-        if (!dataFile.is_open()) {
-            cerr << "Error opening file: " << inputFileName << endl;
-            return;
+
+    // Branch and bound for one maximum clique instead of listing them all;
+    // the clique also goes to output when given
+    void detectMaximumClique(CliqueSink* output = nullptr) {
+        auto startTime = high_resolution_clock::now();
+        CoreDecomposition cores = decomposeCores(graph, loadThreads);
+        MaxCliqueSearch search(graph, cores.order, 1, &cores.coreNumber);
+        vector<int> clique = search.run();
+        if (!fileIds.empty()) {
+            for (int& vertex : clique) vertex = fileIds[vertex];
         }
+        sort(clique.begin(), clique.end());
+        auto endTime = high_resolution_clock::now();
 
-        string textLine;
-        int edgeCount = 0, maxVertex = -1;
-        bool metadataFound = false;
+        if (output && !clique.empty()) output->write(0, clique.data(), clique.size());
+        cout << "Maximum clique size: " << clique.size() << endl;
+        cout << "Maximum clique:";
+        for (int vertex : clique) cout << " " << vertex;
+        cout << endl;
+        cout << "Execution time: " << duration_cast<microseconds>(endTime - startTime).count() / 1000.0 << " ms" << endl;
+    }
 
-        // Find header
-        while (getline(dataFile, textLine)) {
-            // Skip empty lines and comments
-            if (textLine.empty() || textLine[0] == '#') {
-                // Check if this comment line contains metadata
-                if (textLine.find("Nodes:") != string::npos && textLine.find("Edges:") != string::npos) {
-                    // Parse metadata line to extract vertex and edge counts
-                    stringstream parser(textLine);
-                    string skipWord;
-                    parser >> skipWord >> skipWord >> vertexCount >> skipWord >> edgeCount;
-                    metadataFound = true;
-                }
-            }
-            // If we reach a non-empty, non-comment line, exit the loop
-            else {
-                break;
+    bool readGraphData(const string& inputFileName) {
+        PROFILE_PHASE(LOAD);
+        fileIds.clear();
+        // Binary snapshots are mapped directly
+        if (isGraphSnapshot(inputFileName)) {
+            GraphSnapshot snapshot;
+            string error;
+            if (!loadGraphSnapshot(inputFileName, snapshot, error)) {
+                cerr << "Error loading snapshot: " << error << endl;
+                return false;
             }
+            graph = move(snapshot.graph);
+            vertexCount = graph.vertexCount();
+            fileIds = move(snapshot.originalIds);
+            cout << "Graph loaded: " << vertexCount << " nodes, " << graph.edgeCount() << " edges." << endl;
+            return true;
         }
 
-        if (!metadataFound) {
-            cerr << "Could not find header with node and edge count! Attempting to determine from data." << endl;
-            // We'll proceed by inferring vertex count from input data
+        EdgeListData fileData;
+        if (!loadEdgeList(inputFileName, fileData, false, loadThreads)) {
+            cerr << "Error opening file: " << inputFileName << endl;
+            return false;
         }
 
-        // Determine actual max node ID
-        dataFile.clear();
-        dataFile.seekg(0, ios::beg);
-       
-        // Continue reading the file line by line
-        while (getline(dataFile, textLine)) {
-            // Skip lines that are:
-            // 1. Empty
-            // 2. Start with # (comments)
-            // 3. Contain column headers
-            if (textLine.empty() ||
-                textLine[0] == '#' ||
-                textLine.find("FromNodeId") != string::npos) {
-                continue;
-            }
-           
-            // Process valid data lines
-            stringstream parser(textLine);
-            int src, dst;
-           
-            // Extract source and destination vertices and check if extraction was successful
-            if (parser >> src >> dst) {
-                // Update the maximum vertex ID if extraction was successful
-                maxVertex = max(maxVertex, max(src, dst));
-            }
+        if (fileData.headerFound) {
+            vertexCount = static_cast<int>(min<int64_t>(fileData.declaredNodes, INT_MAX));
+        } else {
+            cerr << "Could not find header with node and edge count! Attempting to determine from data." << endl;
+            // We'll proceed by inferring vertex count from input data
         }
 
-        if (maxVertex < 0) {
+        if (fileData.maxVertexId < 0) {
             cerr << "No valid edges found in file!" << endl;
-            return;
+            return false;
         }
 
-        // Resize adjacency list
-        vertexCount = max(vertexCount, maxVertex + 1);
-        neighbors.resize(vertexCount);
+        // Size the vertex range
+        vertexCount = max(vertexCount, fileData.maxVertexId + 1);
 
-        // Reset file position
-        dataFile.clear();
-        dataFile.seekg(0, ios::beg);
+        // Tally self-loops and out-of-range edges per parsing block; the
+        // graph build drops both
+        int threadCount = loadThreads;
+        vector<array<int, 3>> blockTallies(fileData.edgeBlocks.size(), array<int, 3>{0, 0, 0});
+        parallelFor(0, fileData.edgeBlocks.size(), threadCount, [&](int64_t lo, int64_t hi, int) {
+            for (int64_t b = lo; b < hi; b++) {
+                for (const auto& edge : fileData.edgeBlocks[b]) {
+                    int src = edge.first;
+                    int dst = edge.second;
+                    if (src == dst) {
+                        blockTallies[b][1]++;
+                    } else if (src >= 0 && dst >= 0 && src < vertexCount && dst < vertexCount) {
+                        blockTallies[b][0]++;
+                    } else {
+                        blockTallies[b][2]++;
+                    }
+                }
+            }
+        });
 
-        // Read edges
         int validEdgeCount = 0;
         int selfLoopCount = 0;
         int invalidEdgeCount = 0;
-       
-        while (getline(dataFile, textLine)) {
-            // Skip lines that aren't data
-            bool skipLine = textLine.empty() ||
-                            textLine[0] == '#' ||
-                            textLine.find("FromNodeId") != string::npos;
-            if (skipLine) continue;
-           
-            // Parse the edge information
-            stringstream parser(textLine);
-            int src;
-            int dst;
-            bool parseSuccess = (parser >> src >> dst) ? true : false;
-           
-            // Process valid edge data
-            if (parseSuccess) {
-                // Handle self-loops
-                if (src == dst) {
-                    selfLoopCount++;
-                    continue;
-                }
-               
-                // Handle out-of-range vertices
-                bool verticesValid = src >= 0 && dst >= 0 &&
-                                    src < vertexCount && dst < vertexCount;
-                if (!verticesValid) {
-                    invalidEdgeCount++;
-                    continue;
-                }
-               
-                // Add valid edge to the graph
-                neighbors[src].insert(dst);
-                neighbors[dst].insert(src);
-                validEdgeCount++;
-            }
+        for (const auto& tally : blockTallies) {
+            validEdgeCount += tally[0];
+            selfLoopCount += tally[1];
+            invalidEdgeCount += tally[2];
         }
 
+        graph = CSRGraph::fromEdgeBlocks(vertexCount, fileData.edgeBlocks, threadCount);
+
         cout << "Graph loaded: " << vertexCount << " nodes, " << validEdgeCount << " edges." << endl;
        
         if (invalidEdgeCount > 0)
@@ -175,142 +182,149 @@ while (vertexIndex < vertexCount) {
            
         if (selfLoopCount > 0)
             cout << "Note: " << selfLoopCount << " self-loops were ignored." << endl;
-           
-        dataFile.close();
+        return true;
+    }
+
+    bool writeSnapshot(const string& outputFileName) {
+        string error;
+        if (!saveGraphSnapshot(outputFileName, graph, nullptr, fileIds.empty() ? nullptr : &fileIds, error)) {
+            cerr << "Error saving snapshot: " << error << endl;
+            return false;
+        }
+        cout << "Snapshot written: " << outputFileName << endl;
+        return true;
     }
 
 private:
-    void recordClique(const unordered_set<int>& clique) {
-        totalCliques++;
-        int size = clique.size();
+    template <class Visitor>
+    void searchDegeneracyOrder(Visitor& visitor) {
+        searchNodes = 0;
+        // Degeneracy order: each vertex starts a search over its later
+        // neighbors, excluding its earlier ones, so no set outgrows the
+        // degeneracy (isolated vertices are not reported)
+        CoreDecomposition cores = decomposeCores(graph, loadThreads);
+        const vector<int>& order = cores.order;
+        vector<int> position(vertexCount);
+        for (int i = 0; i < vertexCount; i++) position[order[i]] = i;
 
-        if (size > largestCliqueSize) largestCliqueSize = size;
-        cliqueSizeDistribution[size]++;
-    }
-   
-    // Find a pivot vertex that maximizes connections
-    int selectPivot(const unordered_set<int>& candidateVertices, const unordered_set<int>& excludedVertices) {
-        int bestVertex = -1, maxConnections = -1;
+        int maxLaterDegree = 0;
+        for (int i = 0; i < vertexCount; i++) {
+            int later = 0;
+            for (int w : graph.neighbors(order[i])) later += position[w] > i;
+            maxLaterDegree = max(maxLaterDegree, later);
+        }
+        // One level per clique vertex; sized once so references stay valid
+        levels.assign(maxLaterDegree + 2, SearchLevel());
+        pivotScores.reset(vertexCount);
+        CliqueTrail<Visitor::needsMembers> currentClique;
 
-        // Check candidates for best pivot
-        // Check candidates for best pivot
-auto candidateIter = candidateVertices.begin();
-while (candidateIter != candidateVertices.end()) {
-    int vertex = *candidateIter;
-    int connectionCount = 0;
-   
-    auto innerIter = candidateVertices.begin();
-    while (innerIter != candidateVertices.end()) {
-        if (neighbors[vertex].count(*innerIter))
-            connectionCount++;
-        innerIter++;
-    }
-   
-    if (connectionCount > maxConnections) {
-        maxConnections = connectionCount;
-        bestVertex = vertex;
-    }
-   
-    candidateIter++;
-}
+        // Cliques of the minimum size all lie in the (size - 1)-core, so
+        // vertices outside it are dropped from every set. A clique of at
+        // least that size that is maximal in the core is maximal in the
+        // graph: a vertex extending it would lie in the core too
+        int coreFloor = minCliqueSize - 1;
+        auto outsideCore = [&](int v) { return cores.coreNumber[v] < coreFloor; };
 
-        // Check excluded vertices
-        // Check excluded vertices
-auto excludedIter = excludedVertices.begin();
-while (excludedIter != excludedVertices.end()) {
-    int vertex = *excludedIter;
-    int connectionCount = 0;
-   
-    auto innerIter = candidateVertices.begin();
-    while (innerIter != candidateVertices.end()) {
-        if (neighbors[vertex].count(*innerIter))
-            connectionCount++;
-        innerIter++;
-    }
-   
-    if (connectionCount > maxConnections) {
-        maxConnections = connectionCount;
-        bestVertex = vertex;
+        PROFILE_PHASE(SEARCH);
+        for (int i = 0; i < vertexCount; i++) {
+            PROFILE_ROOT();
+            int vertex = order[i];
+            if (graph.degree(vertex) == 0 || outsideCore(vertex)) continue;
+
+            SearchLevel& top = levels[0];
+            top.candidates.clear();
+            top.excluded.clear();
+            for (int w : graph.neighbors(vertex)) {
+                if (outsideCore(w)) {
+                    continue;
+                } else if (position[w] > i) {
+                    top.candidates.push_back(w);
+                } else {
+                    top.excluded.push_back(w);
+                }
+            }
+            currentClique.push(vertex);
+            expandClique(0, currentClique, visitor);
+            currentClique.pop();
+        }
     }
-   
-    excludedIter++;
-}
 
-        // Provide fallback if no proper pivot was found but sets aren't empty
-        // Provide fallback if no proper pivot was found but sets aren't empty
-if (bestVertex == -1) {
-    auto candidateIter = candidateVertices.begin();
-    if (candidateIter != candidateVertices.end())
-        return *candidateIter;
-   
-    auto excludedIter = excludedVertices.begin();
-    if (excludedIter != excludedVertices.end())
-        return *excludedIter;
-}
-        return bestVertex;
+    // Neighbors of vertex inside a sorted set, in ascending order
+    void neighborsIn(int vertex, const vector<int>& vertexSet, vector<int>& result) {
+        NeighborRange adjacent = graph.neighbors(vertex);
+        intersectInto(adjacent.begin(), adjacent.size(), vertexSet.data(), vertexSet.size(), result);
     }
    
-    // Bron-Kerbosch with pivoting (recursive)
-    void expandClique(unordered_set<int>& excludedVertices, unordered_set<int>& candidateVertices, unordered_set<int>& currentClique) {
-        if (candidateVertices.empty() && excludedVertices.empty()) {
-            recordClique(currentClique);
+    // Bron-Kerbosch with pivoting (recursive) on the sets of levels[depth]
+    template <class Visitor>
+    void expandClique(int depth, CliqueTrail<Visitor::needsMembers>& currentClique, Visitor& visitor) {
+        SearchLevel& level = levels[depth];
+        vector<int>& candidateVertices = level.candidates;
+        vector<int>& excludedVertices = level.excluded;
+        if (currentClique.size() + static_cast<int>(candidateVertices.size()) < minCliqueSize) return;
+        PROFILE_NODE(currentClique.size());
+        searchNodes++;
+        if (candidateVertices.empty()) {
+            if (excludedVertices.empty()) visitor.visit(currentClique.data(), currentClique.size());
             return;
         }
 
-        // Choose pivot (only if both sets aren't empty)
-        int pivotVertex = -1;
-        if (!candidateVertices.empty() || !excludedVertices.empty()) {
-            pivotVertex = selectPivot(candidateVertices, excludedVertices);
-        }
-
-        // Convert set to vector for safe iteration
-        vector<int> vertexList(candidateVertices.begin(), candidateVertices.end());
-       
-        for (int vertex : vertexList) {
-            // Skip vertices connected to pivot (pivoting optimization)
-            if (pivotVertex != -1 && pivotVertex >= 0 && pivotVertex < vertexCount &&
-                neighbors[pivotVertex].count(vertex)) {
-                continue;
-            }
+        // Only candidates outside the pivot's neighborhood are expanded
+        int pivotVertex = pickPivot(pivotRule, graph, pivotScores, candidateVertices.data(), candidateVertices.size(),
+                                    excludedVertices.data(), excludedVertices.size());
+        NeighborRange pivotNeighbors = graph.neighbors(pivotVertex);
+        level.branches.clear();
+        set_difference(candidateVertices.begin(), candidateVertices.end(),
+                       pivotNeighbors.begin(), pivotNeighbors.end(), back_inserter(level.branches));
 
-            // Add vertex to clique
-            currentClique.insert(vertex);
-
-            // Create new candidate and excluded sets
-            unordered_set<int> newExcluded, newCandidates;
-           
-           
-            // Create neighbor intersection for candidate vertices
-            for (int v : candidateVertices) {
-                if (vertex != v && neighbors[vertex].count(v))
-                    newCandidates.insert(v);
-            }
-           
-            // Create neighbor intersection for excluded vertices
-            for (int v : excludedVertices) {
-                if (neighbors[vertex].count(v))
-                    newExcluded.insert(v);
-            }
-           
-           
-           
+        SearchLevel& next = levels[depth + 1];
+        for (int vertex : level.branches) {
+            // Add vertex to clique and restrict both sets to its neighbors
+            currentClique.push(vertex);
+            neighborsIn(vertex, candidateVertices, next.candidates);
+            neighborsIn(vertex, excludedVertices, next.excluded);
 
             // Recursive call
-            expandClique(newExcluded, newCandidates, currentClique);
+            expandClique(depth + 1, currentClique, visitor);
 
             // Move vertex
-            currentClique.erase(vertex);
-            candidateVertices.erase(vertex);
-            excludedVertices.insert(vertex);
+            currentClique.pop();
+            candidateVertices.erase(lower_bound(candidateVertices.begin(), candidateVertices.end(), vertex));
+            excludedVertices.insert(upper_bound(excludedVertices.begin(), excludedVertices.end(), vertex), vertex);
         }
     }
 };
 
-int main() {
+int main(int argc, char* argv[]) {
     MaximalCliquesFinder cliqueDetector;
-    string dataFile = "Email-Enron.txt";
+    RunOptions options;
+    if (!parseRunOptions(argc, argv, options)) return 1;
+    setops::activeKernel();  // calibrate on this host before anything is timed
+    if (options.engine != "bk") {
+        cerr << "Unknown engine: " << options.engine << endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (options.topCount > 0 || options.relabel || !options.checkpointFile.empty()) {
+        cerr << (options.topCount > 0 ? "--top" : options.relabel ? "--relabel" : "--checkpoint")
+             << " is not supported by this finder" << endl;
+        return 1;
+    }
+    cliqueDetector.setLoadThreads(options.loadThreads());
+    cliqueDetector.setMinimumCliqueSize(options.minSize);
+    cliqueDetector.setPivotRule(options.pivotRule);
+    CliqueSink sink;
+    if (!openCliqueOutput(options, sink)) return 1;
+    string dataFile = options.inputFile;
     cout << "Loading graph from file: " << dataFile << endl;
-    cliqueDetector.readGraphData(dataFile);
-    cliqueDetector.detectMaximalCliques();
+    if (!cliqueDetector.readGraphData(dataFile)) return 1;
+    if (!options.snapshotOutput.empty() && !cliqueDetector.writeSnapshot(options.snapshotOutput)) return 1;
+    if (options.maxClique) {
+        cliqueDetector.detectMaximumClique(sink.isOpen() ? &sink : nullptr);
+    } else {
+        cliqueDetector.detectMaximalCliques(sink.isOpen() ? &sink : nullptr);
+    }
+    if (!closeCliqueOutput(options, sink)) return 1;
+    PROFILE_REPORT();
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,86 @@
+#ifndef VERTEX_PARTITION_H
+#define VERTEX_PARTITION_H
+
+#include <vector>
+
+#include "csr_graph.h"
+#include "ego_subgraph.h"
+#include "pivot_rule.h"
+
+// X and P of an in-place Bron-Kerbosch search over an ego subgraph, kept as
+// the adjacent ranges X = [beginX, beginP) and P = [beginP, beginR) of one
+// array of local IDs. A lookup gives each vertex's position, so moving a
+// vertex between the ranges is one swap. A frame only swaps vertices
+// inside its own ranges and puts them back before returning, so its
+// caller's ranges still hold the same sets. One instance is reused per
+// worker.
+class VertexPartition {
+public:
+    // Lays out ego's excluded vertices and then its candidates from
+    // position 0, so X = [0, beginP) and P = [beginP, beginR).
+    void arrange(const EgoSubgraph& ego, int& beginP, int& beginR) {
+        int localCount = ego.graph().vertexCount();
+        vertexSets.resize(localCount);
+        vertexLookup.resize(localCount);
+        for (int v = 0; v < localCount; v++) vertexSets[v] = vertexLookup[v] = v;
+        int position = 0;
+        for (int x : ego.excluded()) moveTo(x, position++);
+        beginP = position;
+        for (int p : ego.candidates()) moveTo(p, position++);
+        beginR = position;
+    }
+
+    // Puts v at position; the vertex there takes v's old slot.
+    void moveTo(int v, int position) {
+        int from = vertexLookup[v];
+        int displaced = vertexSets[position];
+        vertexSets[position] = v;
+        vertexLookup[v] = position;
+        vertexSets[from] = displaced;
+        vertexLookup[displaced] = from;
+    }
+
+    int operator[](int position) const { return vertexSets[position]; }
+    const int* at(int position) const { return vertexSets.data() + position; }
+
+    // The pivot under rule of the frame over X = [beginX, beginP) and a
+    // nonempty P = [beginP, beginR).
+    int pivot(PivotRule rule, const CSRGraph& local, PivotScores& scores, int beginX, int beginP,
+              int beginR) const {
+        return pickPivot(rule, local, scores, at(beginP), beginR - beginP, at(beginX), beginP - beginX);
+    }
+
+    // Gathers the vertices of [begin, end) found in neighbors at the back of
+    // the range and returns the position of the first of them.
+    int gatherAtBack(NeighborRange neighbors, int begin, int end) {
+        int start = end;
+        for (int w : neighbors) {
+            int position = vertexLookup[w];
+            if (position >= begin && position < start) moveTo(w, --start);
+        }
+        return start;
+    }
+
+    // Narrows the frame over [beginX, beginP) and [beginP, beginR) to the
+    // vertices found in neighbors: they move to the P/X boundary, so the
+    // child's X is [childBeginX, beginP) and its P is [beginP, childBeginR).
+    void narrow(NeighborRange neighbors, int beginX, int beginP, int beginR, int& childBeginX,
+                int& childBeginR) {
+        childBeginX = beginP;
+        childBeginR = beginP;
+        for (int w : neighbors) {
+            int position = vertexLookup[w];
+            if (position >= beginX && position < childBeginX) {
+                moveTo(w, --childBeginX);
+            } else if (position >= childBeginR && position < beginR) {
+                moveTo(w, childBeginR++);
+            }
+        }
+    }
+
+private:
+    std::vector<int> vertexSets;
+    std::vector<int> vertexLookup;  // position of each local ID in vertexSets
+};
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef WORK_STEALING_H
+#define WORK_STEALING_H
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <cstdint>
+
+// Fixed set of workers, each with its own task deque. A worker pops its
+// newest task first; an idle worker steals the oldest task of a random
+// victim, which for recursively split work is the largest remaining piece.
+class WorkStealingPool {
+public:
+    typedef std::function<void(int worker)> Task;
+
+    explicit WorkStealingPool(int workers)
+        : pendingTasks(0), idleWorkers(0) {
+        if (workers < 1) workers = 1;
+        for (int w = 0; w < workers; w++) queues.emplace_back(new Queue());
+    }
+
+    int workerCount() const { return static_cast<int>(queues.size()); }
+
+    // Queues a task on a worker's deque. Safe to call from running tasks.
+    void spawn(int worker, Task task) {
+        pendingTasks.fetch_add(1, std::memory_order_relaxed);
+        Queue& queue = *queues[worker];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        queue.tasks.push_back(std::move(task));
+    }
+
+    // True while at least one worker is looking for work.
+    bool hasIdleWorkers() const { return idleWorkers.load(std::memory_order_relaxed) > 0; }
+
+    // Whether a search frame with this many branch candidates should hand its
+    // remaining branches to the pool. Small frames finish faster than a steal.
+    bool shouldSplit(size_t candidates) const {
+        return workerCount() > 1 && candidates >= SPLIT_MIN_CANDIDATES && hasIdleWorkers();
+    }
+
+    static const size_t SPLIT_MIN_CANDIDATES = 24;
+
+    // Runs until every queued task, including tasks spawned along the way,
+    // has finished. The calling thread acts as worker 0.
+    void run() {
+        std::vector<std::thread> threads;
+        for (int w = 1; w < workerCount(); w++) {
+            threads.emplace_back([this, w]() { workerLoop(w); });
+        }
+        workerLoop(0);
+        for (auto& thread : threads) thread.join();
+    }
+
+private:
+    struct alignas(64) Queue {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    bool popLocal(int worker, Task& task) {
+        Queue& queue = *queues[worker];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        if (queue.tasks.empty()) return false;
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(int thief, uint32_t& seed, Task& task) {
+        int workers = workerCount();
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        int start = static_cast<int>(seed % workers);
+        for (int k = 0; k < workers; k++) {
+            int victim = (start + k) % workers;
+            if (victim == thief) continue;
+            Queue& queue = *queues[victim];
+            std::lock_guard<std::mutex> guard(queue.lock);
+            if (queue.tasks.empty()) continue;
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+    void workerLoop(int worker) {
+        uint32_t seed = 2654435761u * static_cast<uint32_t>(worker + 1);
+        bool idle = false;
+        Task task;
+        for (;;) {
+            if (popLocal(worker, task) || steal(worker, seed, task)) {
+                if (idle) {
+                    idleWorkers.fetch_sub(1, std::memory_order_relaxed);
+                    idle = false;
+                }
+                task(worker);
+                task = nullptr;
+                pendingTasks.fetch_sub(1, std::memory_order_acq_rel);
+                continue;
+            }
+            if (pendingTasks.load(std::memory_order_acquire) == 0) break;
+            if (!idle) {
+                idleWorkers.fetch_add(1, std::memory_order_relaxed);
+                idle = true;
+            }
+            std::this_thread::yield();
+        }
+        if (idle) idleWorkers.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::atomic<int64_t> pendingTasks;
+    std::atomic<int> idleWorkers;
+};
+
+namespace workstealing {
+
+template <class Body>
+void runRange(WorkStealingPool& pool, int worker, int64_t begin, int64_t end, int64_t grain,
+              const std::shared_ptr<Body>& body) {
+    // Keep the lower half and leave the upper half for thieves.
+    while (end - begin > grain) {
+        int64_t mid = begin + (end - begin) / 2;
+        int64_t upper = end;
+        pool.spawn(worker, [&pool, mid, upper, grain, body](int w) { runRange(pool, w, mid, upper, grain, body); });
+        end = mid;
+    }
+    for (int64_t i = begin; i < end; i++) (*body)(i, worker);
+}
+
+}
+
+// Queues body(i, worker) for every i in [begin, end) as one range task that
+// splits itself in halves down to grain-sized pieces. Call pool.run() after.
+template <class Body>
+void spawnRange(WorkStealingPool& pool, int64_t begin, int64_t end, int64_t grain, Body body) {
+    if (end <= begin) return;
+    std::shared_ptr<Body> shared = std::make_shared<Body>(std::move(body));
+    pool.spawn(0, [&pool, begin, end, grain, shared](int worker) {
+        workstealing::runRange(pool, worker, begin, end, grain < 1 ? 1 : grain, shared);
+    });
+}
+
+#endif